@@ -2,8 +2,33 @@
 /// @file
 /// @brief eForth implemented in 100% C/C++ for portability and education
 ///
+#include <cstring>     // strcmp, strlen
+#include <climits>     // LONG_MAX, strtol range
 #include <strings.h>   // strcasecmp
-#include "ceforth.h"
+#include <iostream>    // cin, cout
+#include <iomanip>     // setbase, setw, setfill
+#include <fstream>     // ifstream
+#include <sstream>     // stringstream (JS interface)
+#include <vector>      // worker threads, image buffer
+#include "ceforth.h"   // VM context, includes config.h
+#if !DO_WASM && !(_WIN32 || _WIN64)
+#include <fcntl.h>     // open
+#include <unistd.h>    // close
+#include <sys/stat.h>  // fstat
+#include <sys/mman.h>  // mmap, for included
+#endif // !DO_WASM && !(_WIN32 || _WIN64)
+#if USE_IU32 && (_WIN32 || _WIN64)
+#define NOMINMAX       // keep List::max, VMem::max
+#include <windows.h>   // VirtualAlloc, for growable pmem
+#endif // USE_IU32 && (_WIN32 || _WIN64)
+#if DO_STKPAGE
+#include <signal.h>    // sigaction, for stack guard faults
+#include <setjmp.h>    // sigsetjmp
+#endif // DO_STKPAGE
+#if DO_MULTITASK
+#include <deque>       // task queues
+#include <condition_variable>
+#endif // DO_MULTITASK
 ///====================================================================
 ///
 ///> Global memory blocks
@@ -12,23 +37,22 @@
 ///   1.By separating pmem from dictionary,
 ///   * it makes dictionary uniform size which eliminates the need for link field
 ///   * however, it requires array size tuning manually
-///   2.Using 16-bit xt offset in parameter field (instead of full 32 or 64 bits),
-///   * it unified xt/pfa parameter storage and use the LSB for id flag
-///   * that compacts memory usage while avoiding the double lookup of
-///   * token threaded indexing.
-///   * However, it limits function pointer spread within range of 64KB
+///   2.Using a 16-bit token per word in parameter field (instead of full 32 or 64 bits),
+///   * built-ins are indices into Code::XTAB, colon words pfa|EXT_FLAG
+///   * that compacts memory usage with one table lookup per built-in,
+///   * and works however the compiler lays out the lambdas
 ///   3.For ease of byte counting, U8* is used for pmem instead of U16*.
 ///   * this makes IP increment by 2 instead of word size.
 ///   * If needed, it can be readjusted.
 ///
 ///> Dictionary structure (N=E4_DICT_SZ in config.h)
-///     dict[0].xt ---------> pointer to build-in word lambda[0]
-///     dict[1].xt ---------> pointer to built-in word lambda[1]
+///     dict[0].pfa --------> XTAB[0], pointer to build-in word lambda[0]
+///     dict[1].pfa --------> XTAB[1], pointer to built-in word lambda[1]
 ///     ...
-///     dict[N-1].xt -------> pointer to last built-in word lambda[N-1]
+///     dict[N-1].pfa ------> XTAB[N-1], pointer to last built-in word lambda[N-1]
 ///
 ///> Parameter memory structure (memory block=E4_PMEM_SZ in config.h)
-///     dict[N].xt ----+ user defined colon word)    dict[N+1].xt------+
+///     dict[N].pfa ---+ user defined colon word)    dict[N+1].pfa-----+
 ///                    |                                               |
 ///     +--MEM0        v                                               v
 ///     +--------------+--------+--------+-----+------+----------------+-----
@@ -40,7 +64,7 @@
 ///
 ///> Parameter structure - 16-bit aligned (use MSB for colon/primitive word flag)
 ///   * primitive word
-///     16-bit xt offset with MSB set to 1, where opcode < MAX_OP
+///     16-bit opcode with MSB set to 1, where opcode < MAX_OP
 ///     +-+--------------+
 ///     |1|   opcode     |   call exec_prim(opcode)
 ///     +-+--------------+
@@ -52,82 +76,377 @@
 ///     +--------------+-+
 ///
 ///   * built-in word
-///     16-bit xt offset with MSB set to 0 (1 less mem lookup for xt)
+///     16-bit XTAB index with MSB set to 0 (no dict lookup for xt)
 ///     +-+--------------+
-///     |0| dict.xtoff() |   call (XT0 + *IP)() to execute
+///     |0|  dict.xti()  |   call (XTAB[*IP])() to execute
 ///     +-+--------------+
 ///
-List<DU,   E4_RS_SZ>   rs;         ///< return stack
-List<DU,   E4_SS_SZ>   ss;         ///< parameter stack
-List<Code, E4_DICT_SZ> dict;       ///< dictionary
-List<U8,   E4_PMEM_SZ> pmem;       ///< parameter memory (for colon definitions)
-U8  *MEM0 = &pmem[0];              ///< base of parameter memory block
+ForthVM        *vm0 = 0;           ///< first VM, owner of built-in words
+E4_TLS ForthVM *vm  = 0;           ///< current VM context
+E4_TLS Task    *tk  = 0;           ///< current task (vm itself or a spawned one)
 ///
 ///> Macros to abstract dict and pmem physical implementation
 ///  Note:
 ///    so we can change pmem implementation anytime without affecting opcodes defined below
 ///
+///@name VM context access macros (current VM and task)
+///  * function-like and VM_ prefixed, so a local or member named ss,
+///    base or pad is left alone
+///@{
+#define VM_RS()     (tk->_rs)           /**< return stack                             */
+#define VM_SS()     (tk->_ss)           /**< parameter stack                          */
+#define VM_DICT()   (vm->_dict)         /**< dictionary                               */
+#define VM_PMEM()   (vm->_pmem)         /**< parameter memory                         */
+#define VM_HBKT()   (vm->_hbkt)         /**< dict hash bucket heads                   */
+#define VM_HNXT()   (vm->_hnxt)         /**< dict hash chains                         */
+#define VM_DREF()   (vm->_dref)         /**< dict pfa/xt refs, reverse index keys     */
+#define VM_RBKT()   (vm->_rbkt)         /**< reverse index bucket heads               */
+#define VM_RNXT()   (vm->_rnxt)         /**< reverse index chains                     */
+#define VM_DKEY()   (vm->_dkey)         /**< dict name keys (USE_DSOA)                */
+#define VM_DPFA()   (vm->_dpfa)         /**< dict pfa, packed (USE_DSOA)              */
+#define VM_DATTR()  (vm->_dattr)        /**< dict attr, packed (USE_DSOA)             */
+#define VM_IP()     (tk->_ip)           /**< instruction pointer                      */
+#define VM_ST()     (tk->_state)        /**< VM state                                 */
+#define VM_TOS()    (tk->_tos)          /**< top of stack (cached)                    */
+#define VM_COMP()   (vm->_compile)      /**< compiler flag                            */
+#define VM_UPPER()  (vm->_upper)        /**< case sensitivity control                 */
+#define VM_LOADP()  (vm->_load_dp)      /**< depth of recursive include               */
+#define VM_BASE()   (vm->_base)         /**< numeric radix (a pointer)                */
+#define VM_DFLT()   (vm->_dflt)         /**< use float data unit flag                 */
+#define VM_TIN()    (vm->_tin)          /**< input parse pointer                      */
+#define VM_TEND()   (vm->_tend)         /**< end of input                             */
+#define VM_TKEEP()  (vm->_tkeep)        /**< input kept across yield                  */
+#define VM_KEPT()   (vm->_kept)         /**< tin points into tkeep                    */
+#define VM_TOK()    (vm->_tok)          /**< token buffer for word()                  */
+#define VM_FOUT()   (tk->_fout)         /**< forth_out                                */
+#define VM_PAD()    (vm->_pad)          /**< string buffer                            */
+#define VM_FOUTCB() (vm->_fout_cb)      /**< forth output callback                    */
+#define MEM0      (VM_PMEM().v)            /**< base of parameter memory block           */
+///@}
 ///@name Dictionary and data stack access macros
 ///@{
 #define BOOL(f)   ((f)?-1:0)               /**< Forth boolean representation            */
-#define HERE      (pmem.idx)               /**< current parameter memory index          */
-#define LAST      (dict[dict.idx-1])       /**< last colon word defined                 */
+#define HERE      ((IU)VM_PMEM().idx)      /**< current parameter memory index          */
+#define LAST      (VM_DICT()[VM_DICT().idx-1]) /**< last colon word defined                 */
 #define MEM(a)    (MEM0 + (IU)UINT(a))     /**< pointer to address fetched from pmem    */
 #define IGET(ip)  (*(IU*)MEM(ip))          /**< instruction fetch from pmem+ip offset   */
-#define CELL(a)   (*(DU*)&pmem[a])         /**< fetch a cell from parameter memory      */
-#define SETJMP(a) (*(IU*)&pmem[a] = HERE)  /**< address offset for branching opcodes    */
+#if USE_CALIGN
+#define CELL(a)   (*(DU*)__builtin_assume_aligned(&VM_PMEM()[a], sizeof(DU))) /**< compiled cell (add_du), aligned */
+#else  // !USE_CALIGN
+#define CELL(a)   (*(DU*)&VM_PMEM()[a])    /**< fetch a cell from parameter memory      */
+#endif // USE_CALIGN
+#if DO_DIRTY
+#define DIRTY(a,n) dirty((IU)(a), (IU)(n)) /**< pmem[a, a+n) written, see vm_dirty      */
+#define DIRTY_LO() (vm->_dlo = HERE < vm->_dlo ? HERE : vm->_dlo) /**< pmem cut back */
+#else  // !DO_DIRTY
+#define DIRTY(a,n) ((void)0)
+#define DIRTY_LO() ((void)0)
+#endif // DO_DIRTY
+#define SETJMP(a) (DIRTY(a, sizeof(IU)), *(IU*)&VM_PMEM()[a] = HERE) /**< address offset for branching opcodes */
 ///@}
+#if DO_DIRTY
+///
+///> mark 16-byte lines of pmem[a, a+n) for the memory view
+///  * appends (, allot add_*) are not marked, vm_dirty takes [_dlo, HERE)
+///
+inline void dirty(IU a, IU n) {
+    if (!n || a >= E4_PMEM_SZ) return;
+    U32 e = (U32)a + n > E4_PMEM_SZ ? E4_PMEM_SZ : (U32)a + n;
+    for (U32 l = a >> 4; l <= (e - 1) >> 4; l++) vm->_dmap[l >> 3] |= 1 << (l & 7);
+}
+#endif // DO_DIRTY
 ///@name Primitive words
 ///@{
 Code prim[] = {
     Code(";",   EXIT), Code("nop",  NOP),   Code("next", NEXT),  Code("loop", LOOP),
     Code("lit", LIT),  Code("var",  VAR),   Code("str",  STR),   Code("dotq", DOTQ),
     Code("bran",BRAN), Code("0bran",ZBRAN), Code("vbran",VBRAN), Code("does>",DOES),
-    Code("for", FOR),  Code("do",   DO),    Code("key",  KEY)
+    Code("for", FOR),  Code("do",   DO),    Code("key",  KEY),
+    Code("lit+",LADD), Code("over+",OVADD), Code("r@+",  RADD),
+    Code("dup0=0bran", DZBRAN),             Code("1+next",INEXT)
 };
-#define DICT(w) (IS_PRIM(w) ? prim[w & ~EXT_FLAG] : dict[w])
+#define DICT(w) (IS_PRIM(w) ? prim[w & ~EXT_FLAG] : VM_DICT()[w])
 ///@}
-///====================================================================
+void stk_err(int e);                   ///< see Stack errors below
+#if USE_IU32
 ///
-///@name VM states and state variables
+///@name Growable parameter memory - reserve address range, commit on use
+///@note
+///   * WASM has no reservation, the range is taken from the heap at once,
+///   * (browsers back untouched pages of linear memory lazily, and
+///   * -sALLOW_MEMORY_GROWTH is needed, see 'make big')
 ///@{
-typedef enum { STOP=0, HOLD, QUERY, NEST, IO } vm_state;
-
-IU       IP = 0;        ///< instruction pointer
-vm_state VM = QUERY;    ///< VM state
-///
-///> user variables
+VMem::VMem() {
+#if DO_WASM || ARDUINO || ESP32
+    v   = (U8*)malloc(E4_PMEM_SZ);
+    cap = v ? E4_PMEM_SZ : 0;
+#elif _WIN32 || _WIN64
+    v   = (U8*)VirtualAlloc(0, E4_PMEM_SZ, MEM_RESERVE, PAGE_NOACCESS);
+#else  // POSIX
+    v   = (U8*)mmap(0, E4_PMEM_SZ, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (v == MAP_FAILED) v = 0;
+#endif // DO_WASM || ARDUINO || ESP32
+    /* v==0 leaves cap at 0, every grow then reports pmem full */
+}
+VMem::~VMem() {
+#if DO_WASM || ARDUINO || ESP32
+    free(v);
+#elif _WIN32 || _WIN64
+    VirtualFree(v, 0, MEM_RELEASE);
+#else  // POSIX
+    munmap(v, E4_PMEM_SZ);
+#endif // DO_WASM || ARDUINO || ESP32
+}
+bool VMem::grow(int n) {
+    if (n <= cap) return true;
+    if (!v || n > E4_PMEM_SZ) return full();
+    int sz = n + (-n & (E4_PMEM_STEP - 1));        ///< round up to commit step
+    if (sz > E4_PMEM_SZ) sz = E4_PMEM_SZ;
+#if DO_WASM || ARDUINO || ESP32
+    /* all committed at reserve */
+#elif _WIN32 || _WIN64
+    if (!VirtualAlloc(v, sz, MEM_COMMIT, PAGE_READWRITE)) return full();
+#else  // POSIX
+    if (mprotect(v, sz, PROT_READ | PROT_WRITE)) return full();
+#endif // DO_WASM || ARDUINO || ESP32
+    cap = sz;
+    return true;
+}
+bool VMem::full() {                    ///< abort the line once, the write is dropped
+    if (VM_ST() != STOP) stk_err(-5);
+    return false;
+}
+///@}
+#endif // USE_IU32
 ///
-DU   tos     = -DU1;    ///< top of stack (cached)
-bool compile = false;   ///< compiler flag
-bool upper   = false;   ///< case sensitivity control
-IU   load_dp = 0;       ///< depth of recursive include
-IU   *base;             ///< numeric radix (a pointer)
-IU   *dflt;             ///< use float data unit flag
+///@name Stacks - sized per VM, overflow caught without a check per push
+///@note
+///   * DO_STKPAGE: mapped between two PROT_NONE pages, the top cell right
+///   * below the upper one, a fault there is taken back to vm_eval or
+///   * task_run by siglongjmp and reported like a stack check (stk_err)
+///   * DO_STKPAD: sentinel cells, an overflow within E4_STK_PAD cells is
+///   * caught when nest() returns, further ones may hit the heap
+///@{
+#if DO_STKPAGE
+static int stk_pg() { static int pg = (int)sysconf(_SC_PAGESIZE); return pg; }
+#endif // DO_STKPAGE
+#if DO_STKPAD
+#define STK_MAGIC   0xa5                 /**< sentinel byte */
+#endif // DO_STKPAD
+void Stack::resize(int n) {
+    if (n < 1) n = 1;
+    release();
+#if DO_STKPAGE
+    int pg = stk_pg();
+    int nb = (n * (int)sizeof(DU) + pg - 1) & ~(pg - 1);  ///< cells, page rounded
+    bsz = nb + 2 * pg;                                    /// * guard below and above
+    blk = (U8*)mmap(0, bsz, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (blk == MAP_FAILED) { blk = 0; throw "ERR: Stack allot failed"; }
+    mprotect(blk, pg, PROT_NONE);
+    mprotect(blk + pg + nb, pg, PROT_NONE);
+    v = (DU*)(blk + pg + nb) - n;                         /// * top against the guard
+#else  // !DO_STKPAGE
+#if DO_STKPAD
+    int np = E4_STK_PAD;                                  ///< sentinel cells each end
+#else  // !DO_STKPAD
+    int np = 0;
+#endif // DO_STKPAD
+    bsz = (n + 2 * np + E4_SFX_MARGIN) * (int)sizeof(DU);  /// * slack, top level ops are checked after
+    blk = (U8*)malloc(bsz);
+    if (!blk) throw "ERR: Stack allot failed";
+    v = (DU*)blk + np;
+#endif // DO_STKPAGE
+    sz  = n;
+    idx = max = 0;
+    arm();
+}
+void Stack::release() {
+    if (!blk) return;
+#if DO_STKPAGE
+    munmap(blk, bsz);
+#else  // !DO_STKPAGE
+    free(blk);
+#endif // DO_STKPAGE
+    blk = 0; v = 0; sz = 0;
+}
+int Stack::guard(const void *a) const {
+#if DO_STKPAGE
+    const U8 *p = (const U8*)a;
+    if (!blk || p < blk || p >= blk + bsz) return 0;
+    if (p >= (const U8*)(v + sz)) return 1;
+    if (p <  blk + stk_pg())      return -1;
+#endif // DO_STKPAGE
+    return 0;
+}
+int Stack::bad() const {             ///< the cell next to each end is hit first
+#if DO_STKPAD
+    const U8 *hi = (const U8*)(v + sz), *lo = (const U8*)v - sizeof(DU);
+    for (int i = 0; i < (int)sizeof(DU); i++) {
+        if (hi[i] != STK_MAGIC) return 1;
+        if (lo[i] != STK_MAGIC) return -1;
+    }
+#endif // DO_STKPAD
+    return 0;
+}
+void Stack::arm() {
+#if DO_STKPAD
+    memset(blk, STK_MAGIC, E4_STK_PAD * sizeof(DU));
+    memset(v + sz, STK_MAGIC, E4_STK_PAD * sizeof(DU));
+#endif // DO_STKPAD
+}
 ///@}
+///====================================================================
+///
 ///
 ///> inline functions to reduce verbosity
 ///
-inline void PUSH(DU v) { ss.push(tos); tos = v; }
-inline DU   POP()      { DU n=tos; tos=ss.pop(); return n; }
+inline void PUSH(DU v) { VM_SS().push(VM_TOS()); VM_TOS() = v; }
+inline DU   POP()      { DU n=VM_TOS(); VM_TOS()=VM_SS().pop(); return n; }
+inline DU   CGET(IU a) { DU v; memcpy(&v, &VM_PMEM()[a], sizeof(DU)); return v; } ///< cell at a user address, any alignment
+inline void CSET(IU a, DU v) { memcpy(&VM_PMEM()[a], &v, sizeof(DU)); }
 ///
 ///====================================================================
 ///
 ///@name Dictionary search functions - can be adapted for ROM+RAM
+///@brief
+///    * words are chained into hash buckets, newest first, so the
+///    * most recent definition shadows the older ones (same as a
+///    * reverse linear scan, but O(1) on average)
+///    * hash is always case-folded, so case! needs no rehash
+///    * USE_DSOA: beside the array of Code, dict keeps three packed arrays
+///      by index: a name key (length, hash byte, 6-char prefix) that find
+///      checks before it fetches the name, and pfa and attr, which the
+///      outer interpreter (IS_IMM, CALL, add_w) reads instead of Code;
+///      dict_sync refreshes them whenever a Code entry changes
+///    * reverse index: refs (pfa|EXT_FLAG of colon words, token of built-ins)
+///      are hashed the same way, so pfa2didx (see, profiler, JIT, stack
+///      checks) is O(1) on average instead of a scan of dict
+///    * both indexes (_hbkt/_hnxt, _dref/_rbkt/_rnxt) are always built,
+///      no config flag turns them off
 ///@{
-IU find(const char *s) {
-    auto streq = [](const char *s1, const char *s2) {
-        return upper ? strcasecmp(s1, s2)==0 : strcmp(s1, s2)==0;
+U32 dict_fnv(const char *s, int n) {   ///< FNV-1a, case-folded
+    U32 h = 2166136261u;
+    for (const char *e = s + n; s < e; s++) {
+        U8 c = (U8)*s;
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        h = (h ^ c) * 16777619u;
+    }
+    return h;
+}
+#define DICT_BKT(h)    ((IU)((h) & (E4_HASH_SZ - 1)))  ///< hash bucket
+#if USE_DSOA
+DictKey dict_key(const char *s, int n, U32 h) {  ///< packed key of a name
+    DictKey k = {};
+    k.len = (U8)(n < 255 ? n : 255);
+    k.h   = (U8)(h >> 24);             /// * bucket takes the low bits
+    for (int i = 0; i < n && i < (int)sizeof(k.pfx); i++) {
+        U8 c = (U8)s[i];
+        k.pfx[i] = (char)((c >= 'A' && c <= 'Z') ? c + 'a' - 'A' : c);
+    }
+    return k;
+}
+void dict_sync(IU i) {                 ///< dict[i] pfa or attr changed, i.e. immediate, is
+    VM_DPFA()[i]  = VM_DICT()[i].pfa;
+    VM_DATTR()[i] = (U8)VM_DICT()[i].attr;
+}
+#define DICT_SYNC(i)   dict_sync(i)
+#define DICT_PFA(w)    (VM_DPFA()[w])
+#else  // !USE_DSOA
+#define DICT_SYNC(i)
+#define DICT_PFA(w)    (VM_DICT()[w].pfa)
+#endif // USE_DSOA
+IU dict_ref(Code &c) {                 ///< what pfa2didx looks up
+    return (c.attr & UDF_ATTR) ? (IU)(c.pfa | EXT_FLAG) : c.xti();
+}
+#define REF_BKT(r)     ((IU)((((U32)(r) * 2654435761u) >> 16) & (E4_HASH_SZ - 1)))  ///< ref bucket
+void ref_link(IU i) {                  ///< index dict[i] by dref[i], chains kept descending
+    IU *p = &VM_RBKT()[REF_BKT(VM_DREF()[i])];
+    while (*p > i) p = &VM_RNXT()[*p];
+    VM_RNXT()[i] = *p;
+    *p      = i;
+}
+void ref_unlink(IU i) {
+    IU *p = &VM_RBKT()[REF_BKT(VM_DREF()[i])];
+    while (*p && *p != i) p = &VM_RNXT()[*p];
+    if (*p) *p = VM_RNXT()[i];
+}
+void dict_reref(IU w) {                ///< xt of w changed, i.e. is
+    ref_unlink(w);
+    VM_DREF()[w] = dict_ref(VM_DICT()[w]);
+    ref_link(w);
+}
+#if DO_WASM
+#define DICT_CUT(w)    (vm->_dgen++, vm->_dcut = (w) < vm->_dcut ? (w) : vm->_dcut) ///< words from w on changed (see vm_dict_pack)
+#else  // !DO_WASM
+#define DICT_CUT(w)
+#endif // DO_WASM
+void dict_add(Code &c) {               ///< add a word and index it
+    IU  i = VM_DICT().idx;
+    int n = (int)strlen(c.name);
+    U32 f = dict_fnv(c.name, n);
+    IU  h = DICT_BKT(f);
+    VM_DICT().push(c);
+    DICT_CUT(i);
+#if USE_DSOA
+    VM_DKEY()[i]  = dict_key(c.name, n, f);
+    DICT_SYNC(i);
+#endif // USE_DSOA
+    VM_DREF()[i]  = dict_ref(c);
+    if (!i) return;                    /// * dict[0] is never searched
+    VM_HNXT()[i]  = VM_HBKT()[h];      /// * chain in front (newest wins)
+    VM_HBKT()[h]  = i;
+    ref_link(i);
+}
+#if DO_SCHECK
+void sfx_flush(IU p);                  ///< drop stack effects from p on (see Stack effect analysis)
+#define SFX_FLUSH(p) sfx_flush(p)
+#else  // !DO_SCHECK
+#define SFX_FLUSH(p)
+#endif // DO_SCHECK
+#if DO_JIT
+void jit_flush();                      ///< drop JIT code (see Baseline JIT)
+#define JIT_FLUSH()  jit_flush()
+#else  // !DO_JIT
+#define JIT_FLUSH()
+#endif // DO_JIT
+#if DO_WASM
+#define VM_WAIT(w,a,f) vm_wait(w,a,f)  ///< suspend, JS resumes it (see vm_wait)
+#else  // !DO_WASM
+#define VM_WAIT(w,a,f) 0               ///< native blocks instead
+#endif // DO_WASM
+void dict_clear(IU w) {                ///< rollback dict to w (forget, boot)
+    for (int h = 0; h < E4_HASH_SZ; h++) {
+        while (VM_HBKT()[h] >= w) VM_HBKT()[h] = VM_HNXT()[VM_HBKT()[h]]; /// * chains are in descending order
+        while (VM_RBKT()[h] >= w) VM_RBKT()[h] = VM_RNXT()[VM_RBKT()[h]];
+    }
+    if ((int)w < VM_DICT().idx) SFX_FLUSH((IU)((U8*)VM_DICT()[w].name - MEM0)); /// * name is kept by is
+    VM_DICT().clear(w);                /// * pmem goes with it
+    DICT_CUT(w);
+    JIT_FLUSH();
+}
+IU find(const char *s, int n) {        ///< s needs no '\0' terminator
+    auto streq = [](const char *s1, int n, const char *nm) {
+        return (VM_UPPER() ? strncasecmp(s1, nm, n)==0 : strncmp(s1, nm, n)==0) && !nm[n];
     };
-    IU v = 0;
-    for (IU i = dict.idx - 1; !v && i > 0; --i) {
-        if (streq(s, dict[i].name)) v = i;
+    IU  v = 0;
+    U32 f = dict_fnv(s, n);
+#if USE_DSOA
+    DictKey k = dict_key(s, n, f);
+#endif // USE_DSOA
+    for (IU i = VM_HBKT()[DICT_BKT(f)]; !v && i; i = VM_HNXT()[i]) {
+#if USE_DSOA
+        if (memcmp(&k, &VM_DKEY()[i], sizeof(k))) continue; /// * miss, name not fetched
+#endif // USE_DSOA
+        if (streq(s, n, VM_DICT()[i].name)) v = i;
     }
 #if CC_DEBUG > 1
     LOG_HDR("find", s); if (v) { LOG_DIC(v); } else LOG_NA();
 #endif // CC_DEBUG > 1
     return v;
 }
+IU find(const char *s) { return find(s, strlen(s)); }
 ///@}
 ///====================================================================
 ///
@@ -137,70 +456,745 @@ IU find(const char *s) {
 ///    * if they are combined then can behaves similar to classic Forth
 ///    * with an addition link field added.
 ///@{
-void colon(const char *name) {
-    char *nfa = (char*)&pmem[HERE]; ///> current pmem pointer
+int colon(const char *name) {
+    IU   h0  = HERE;
+    char *nfa = (char*)&VM_PMEM()[h0]; ///> current pmem pointer
     int sz = STRLEN(name);          ///> string length, aligned
-    pmem.push((U8*)name,  sz);      ///> setup raw name field
+    VM_PMEM().push((U8*)name,  sz); ///> setup raw name field
+    if (HERE == h0) return 0;       /// * pmem full, no name to point at
 
-    Code c(nfa, (FPTR)~0, false);   ///> create a local blank word
+    Code c;                         ///> create a local blank word, no XTAB slot
+    c.name = nfa;
     c.attr = UDF_ATTR;              ///> specify a colon (user defined) word
     c.pfa  = HERE;                  ///> capture code field index
 
-    dict.push(c);                   ///> deep copy Code struct into dictionary
+    dict_add(c);                    ///> deep copy Code struct into dictionary
+    return 1;
+}
+void add_iu(IU i) { VM_PMEM().push((U8*)&i, sizeof(IU)); } ///< add an instruction into pmem
+void add_du(DU v) {                 ///< add a cell into pmem
+    while (HERE != DALIGN(HERE)) VM_PMEM().push(0); /// * pad to cell boundary (see DALIGN)
+    VM_PMEM().push((U8*)&v, sizeof(DU));
 }
-void add_iu(IU i) { pmem.push((U8*)&i, sizeof(IU)); }  ///< add an instruction into pmem
-void add_du(DU v) { pmem.push((U8*)&v, sizeof(DU)); }  ///< add a cell into pmem
-int  add_str(const char *s) {       ///< add a string to pmem
-    int sz = STRLEN(s);
-    pmem.push((U8*)s,  sz);         /// * add string terminated with zero
+int  add_str(const char *s, int n) { ///< add a string (not terminated) to pmem
+    int sz = ALIGN(n + 1);
+    VM_PMEM().push((U8*)s, n);
+    for (int i = n; i < sz; i++) VM_PMEM().push(0); /// * terminated with zero
     return sz;
 }
+int  add_str(const char *s) { return add_str(s, strlen(s)); }
 void add_w(IU w) {                  ///< add a word index into pmem
-    Code &c = DICT(w);              /// * is primitive?
     IU   ip = (w & EXT_FLAG)        /// * is primitive?
-        ? (UFP)c.xt                 /// * get primitive/built-in token
-        : (c.attr & UDF_ATTR        /// * colon word?
-           ? (c.pfa | EXT_FLAG)     /// * pfa with colon word flag
-           : c.xtoff());            /// * XT offset of built-in
+        ? prim[w & ~EXT_FLAG].pfa   /// * get primitive opcode
+        : (IS_UDF(w)                /// * colon word?
+           ? (DICT_PFA(w) | EXT_FLAG) /// * pfa with colon word flag
+           : DICT_PFA(w));          /// * XTAB index of built-in
     add_iu(ip);
 #if CC_DEBUG > 1
     LOG_KV("add_w(", w); LOG_KX(") => ", ip);
-    LOGS(" "); LOGS(c.name); LOGS("\n");
+    LOGS(" "); LOGS(DICT(w).name); LOGS("\n");
 #endif // CC_DEBUG > 1
 }
 void add_var(IU op) {               ///< add a varirable header
     add_w(op);                      /// * VAR or VBRAN
     if (op==VBRAN) add_iu(0);       /// * pad offset field
-    pmem.idx = DALIGN(pmem.idx);    /// * data alignment (WASM 4, other 2)
+    VM_PMEM().idx = DALIGN(VM_PMEM().idx); /// * data alignment (WASM 4, other 2)
     if (op==VAR)   add_du(DU0);     /// * default variable = 0
 }
 int def_word(const char* name) {    ///< display if redefined
-    if (name[0]=='\0') { pstr(" name?", CR); return 0; }  /// * missing name?
+    if (name[0]=='\0') {                                  /// * missing name?
+        if (VM_ST() != STOP) pstr(" name?", CR);          /// * word() told already
+        return 0;
+    }
     if (find(name)) {               /// * word redefined?
         pstr(" reDef? ", CR);
     }
-    colon(name);                    /// * create a colon word
-    return 1;                       /// * created OK
+    return colon(name);             /// * create a colon word, 1: created OK
 }
-char *word() {                      ///< get next idiom
-    static string tmp;              ///< tmp string holder
-    if (!(fetch(tmp))) tmp.clear();  /// * input buffer exhausted?
-    return (char*)tmp.c_str();
+char *word() {                      ///< get next idiom, '\0' terminated
+    Str t;
+    int n = fetch(t) ? t.n : 0;     /// * input buffer exhausted?
+    if (n >= E4_TOK_SZ) {           /// * not cut short, i.e. : <64 chars>
+        VM_FOUT().write(t.s, n);    ///> display error prompt
+        pstr("? too long", CR);
+        VM_COMP() = false;          ///> reset to interpreter mode
+        VM_ST()   = STOP;           ///> skip the rest of the input
+        VM_TIN()  = VM_TEND();
+        n = 0;                      /// * callers see no name
+    }
+    memcpy(VM_TOK(), t.s, n);
+    VM_TOK()[n] = '\0';
+    return VM_TOK();
 }
 void s_quote(prim_op op) {
-    const char *s = scan('"')+1;    ///> string skip first blank
-    if (compile) {
+    Str t = scan('"');
+    if (t.n) { t.s++; t.n--; }      ///> string skip first blank
+    if (VM_COMP()) {
         add_w(op);                  ///> dostr, (+parameter field)
-        add_str(s);                 ///> byte0, byte1, byte2, ..., byteN
+        add_str(t.s, t.n);          ///> byte0, byte1, byte2, ..., byteN
     }
     else {                          ///> use PAD ad TEMP storage
         IU h0  = HERE;              ///> keep current memory addr
-        DU len = add_str(s);        ///> write string to PAD
+        DU len = add_str(t.s, t.n); ///> write string to PAD
         PUSH(h0);                   ///> push string address
         PUSH(len);                  ///> push string length
-        HERE = h0;                  ///> restore memory addr
+        VM_PMEM().idx = h0;         ///> restore memory addr
+    }
+}
+///
+///> Superinstruction fusion (peephole), run by ; on the word just defined
+///  Note:
+///  * fused opcode overwrites the first token in place, the rest are kept
+///    but hopped over, so no branch address needs to be relocated
+///  * a sequence is left alone if any branch (or does>) lands inside it
+///
+int op_len(IU pc) {                 ///< instruction length at pc
+    IU  t = IGET(pc);
+    switch (t) {
+    case LIT:    return DALIGN(pc + sizeof(IU)) - pc + sizeof(DU);
+    case STR:    case DOTQ:
+        return sizeof(IU) + STRLEN((const char*)MEM(pc + sizeof(IU)));
+    case NEXT:   case LOOP: case BRAN: case ZBRAN: case VBRAN:
+    case OVADD:  case RADD: return 2 * sizeof(IU);
+    case LADD:   return DALIGN(pc + sizeof(IU)) - pc + sizeof(DU) + sizeof(IU);
+    case INEXT:  return 3 * sizeof(IU);
+    case DZBRAN: return 4 * sizeof(IU);
+    default:     return sizeof(IU);
+    }
+}
+#if DO_FUSE
+IU tk_dup, tk_zeq, tk_add, tk_over, tk_rat, tk_i, tk_inc;   ///< built-in tokens, captured at init
+const char *rs_words[] = { "i", "leave", ">r", "r>", "r@", "exit", "r" };
+IU tk_rs[sizeof(rs_words) / sizeof(char*)];                 ///< built-ins seeing rs, never inlined
+
+void fuse_init() {
+    auto tk = [](const char *n) { return VM_DICT()[find(n)].xti(); };
+    tk_dup  = tk("dup");  tk_zeq = tk("0="); tk_add = tk("+"); tk_over = tk("over");
+    tk_rat  = tk("r@");   tk_i   = tk("i");  tk_inc = tk("1+");
+    for (unsigned i = 0; i < sizeof(tk_rs) / sizeof(IU); i++) tk_rs[i] = tk(rs_words[i]);
+}
+int is_rs(IU t) {                   ///< built-in that sees rs?
+    for (IU r : tk_rs) if (t==r) return 1;
+    return 0;
+}
+int rs_free(IU pfa) {               ///< colon body calls no rs built-in
+    for (IU p = pfa, t; p < HERE && (t = IGET(p)) != EXIT; p += op_len(p)) {
+        if (t==RADD || (!(t & EXT_FLAG) && is_rs(t))) return 0;   /// * fused r@ + too
+    }
+    return 1;
+}
+void fuse(IU pfa) {
+    auto jmp = [pfa](IU a) {        ///< any branch lands at a?
+        for (IU p = pfa; p < HERE; p += op_len(p)) {
+            IU t = 0;               ///< branch target
+            switch (IGET(p)) {
+            case NEXT: case LOOP:
+            case BRAN: case ZBRAN: t = IGET(p + sizeof(IU));     break;
+            case DZBRAN: t = IGET(p + 3 * sizeof(IU));           break;
+            case INEXT:  t = IGET(p + 2 * sizeof(IU));           break;
+            case DOES:   t = p + sizeof(IU);                     break;
+            }
+            if (t==a) return true;
+        }
+        return false;
+    };
+    IU p = pfa;
+    while (p < HERE) p += op_len(p);
+    if (p != HERE) return;          /// * not plain threaded code, bail
+    DIRTY(pfa, HERE - pfa);         /// * rewritten in place below
+
+    for (p = pfa; p < HERE; p += op_len(p)) {
+        IU t  = IGET(p);
+        IU p1 = p + op_len(p);      ///< 2nd token
+        IU p2 = p1 + sizeof(IU);    ///< 3rd token
+        if (p1 >= HERE || jmp(p1)) continue;
+        IU t1 = IGET(p1);
+        IU op = 0;
+        if      (t==LIT && t1==tk_add)                  op = LADD;
+        else if (t==tk_over && t1==tk_add)              op = OVADD;
+        else if ((t==tk_rat || t==tk_i) && t1==tk_add)  op = RADD;
+        else if (t==tk_inc && t1==NEXT)                 op = INEXT;
+        else if (t==tk_dup && t1==tk_zeq && p2 < HERE &&
+                 IGET(p2)==ZBRAN && !jmp(p2))            op = DZBRAN;
+        if (op) IGET(p) = op;       /// * fuse in place
+#if DO_INLINE
+        else if ((t & EXT_FLAG) && !IS_PRIM(t) && t1==EXIT &&
+                 rs_free(t & ~EXT_FLAG)) {
+            IGET(p)  = BRAN;        /// * tail call, callee's ; returns for us
+            IGET(p1) = t & ~EXT_FLAG;
+        }
+#endif // DO_INLINE
+    }
+}
+#if DO_INLINE
+///
+///> inline expansion, a short colon word is copied instead of called
+///  * body up to E4_INLINE bytes, straight-line and rs neutral only
+///  * constants (LIT first) are left alone, 'to' rewrites them in place
+///  * cells are re-emitted by add_du, so USE_CALIGN padding still holds
+///
+int inline_w(IU w) {
+    if (!IS_UDF(w) || (int)w==VM_DICT().idx-1) return 0; /// * not the word being defined
+    IU pfa = VM_DICT()[w].pfa, p = pfa, t;
+    if (IGET(pfa)==LIT) return 0;
+    for (; (t = IGET(p)) != EXIT; p += op_len(p)) {
+        if ((IU)(p + op_len(p) - pfa) > E4_INLINE) return 0;
+        if (IS_PRIM(t)) {
+            if (t!=NOP && t!=LIT && t!=LADD && t!=OVADD) return 0;
+        }
+        else if (!(t & EXT_FLAG) && is_rs(t)) return 0;
     }
+    for (p = pfa; (t = IGET(p)) != EXIT; p += op_len(p)) {
+        int n = op_len(p);
+        if (t==LIT || t==LADD) {
+            add_iu(t);
+            add_du(CELL(DALIGN(p + sizeof(IU))));
+            if (t==LADD) add_iu(IGET(p + n - sizeof(IU)));  /// * the hopped +
+        }
+        else for (int i = 0; i < n; i++) VM_PMEM().push(VM_PMEM()[p + i]);
+    }
+    return 1;
 }
+#else  // !DO_INLINE
+int  inline_w(IU w) { return 0; }
+#endif // DO_INLINE
+#else  // !DO_FUSE
+void fuse_init() {}
+void fuse(IU pfa) {}
+int  inline_w(IU w) { return 0; }
+#endif // DO_FUSE
+///@}
+///====================================================================
+///
+///@name Stack errors - reported and recovered the same way as abort
+///@{
+void stk_err(int e) {                  ///< -1..-4: ss under/overflow, rs over/underflow, -5: pmem full
+    static const char *msg[] = { "ss underflow", "ss overflow", "rs overflow", "rs underflow", "pmem full" };
+    pstr(msg[-e - 1], CR);
+#if DO_TRACE
+    trace_dump(E4_TRACE_DUMP, true);   /// * how we got here, this line only
+#endif // DO_TRACE
+    VM_TOS() = -DU1; VM_SS().clear(); VM_RS().clear();
+    VM_SS().arm();   VM_RS().arm();
+    VM_ST()   = STOP;                  /// * a task ends, the VM aborts its line
+    if (tk != vm) return;              /// * parse and compile state are the VM's
+    VM_COMP() = false;
+    VM_TIN()  = VM_TEND();             /// * skip the rest of the input
+}
+#if DO_STKPAGE
+E4_TLS sigjmp_buf *stk_jb = 0;         ///< where a guard fault lands (vm_eval, task_run)
+struct sigaction  stk_sa0[2];          ///< SIGSEGV, SIGBUS handlers before ours
+
+void stk_sig(int sig, siginfo_t *si, void *) {
+    int s = (tk && stk_jb) ? tk->_ss.guard(si->si_addr) : 0;
+    int r = (tk && stk_jb) ? tk->_rs.guard(si->si_addr) : 0;
+    if (s || r) siglongjmp(*stk_jb, s ? (s > 0 ? -2 : -1) : (r > 0 ? -3 : -4));
+    sigaction(sig, &stk_sa0[sig==SIGBUS], 0);  /// * not ours, fault again the old way
+}
+void stk_init() {                      ///< once, by forth_init
+    struct sigaction sa = {};
+    sa.sa_sigaction = stk_sig;
+    sa.sa_flags     = SA_SIGINFO | SA_NODEFER;  /// * left by siglongjmp, keep it unblocked
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGSEGV, &sa, &stk_sa0[0]);
+    sigaction(SIGBUS,  &sa, &stk_sa0[1]);  /// * macOS reports PROT_NONE as SIGBUS
+}
+///
+///> catch guard faults of the code that follows, e: stk_err code, 0: none yet
+///  volatile: locals changed after STK_CATCH are not restored by siglongjmp
+///
+#define STK_CATCH(e)  sigjmp_buf jb, *jb0 = stk_jb; stk_jb = &jb; int e = sigsetjmp(jb, 0)
+#define STK_UNCATCH() (stk_jb = jb0)
+#define STK_CHECK()
+#else  // !DO_STKPAGE
+void stk_init() {}
+#define STK_CATCH(e)  int e = 0
+#define STK_UNCATCH()
+#if DO_STKPAD
+void stk_check() {                     ///< sentinels, when nest() returns
+    int s = VM_SS().bad(), r = VM_RS().bad();
+    if (s || r) stk_err(s ? (s > 0 ? -2 : -1) : (r > 0 ? -3 : -4));
+}
+#define STK_CHECK()   stk_check()
+#else  // !DO_STKPAD
+#define STK_CHECK()
+#endif // DO_STKPAD
+#endif // DO_STKPAGE
+///@}
+///====================================================================
+///
+///@name Stack effect analysis - checks at word entry (DO_SCHECK in config.h)
+///@brief
+///    * at ; the body is walked along every branch, built-ins are looked
+///      up in sfx_code, colon calls in the table of known words
+///    * a word is known when depths agree wherever paths meet, it leaves
+///      rs balanced, and only calls known words
+///    * nest() checks a known word once at entry against its depth range,
+///      other code is checked before every op, E4_SFX_MARGIN cells apart
+///      from the top, since a single op pushes no more than that
+///@{
+#if DO_SCHECK
+struct SfxCode {                       ///< built-in stack effect
+    const char *name;
+    S8  in, out;                       ///< ss cells taken and given
+    S8  r;                             ///< rs change
+    S8  end;                           ///< 1: returns from the word (exit, leave)
+} sfx_code[] = {
+    { "dup",  1,2 }, { "drop", 1,0 }, { "over", 2,3 }, { "swap", 2,2 }, { "rot",  3,3 },
+    { "-rot", 3,3 }, { "nip",  2,1 }, { "2dup", 2,4 }, { "2drop",2,0 }, { "2over",4,6 },
+    { "2swap",4,4 }, { "+",    2,1 }, { "*",    2,1 }, { "-",    2,1 }, { "/",    2,1 },
+    { "mod",  2,1 }, { "*/",   3,1 }, { "/mod", 2,2 }, { "*/mod",3,2 }, { "and",  2,1 },
+    { "or",   2,1 }, { "xor",  2,1 }, { "abs",  1,1 }, { "negate",1,1}, { "invert",1,1},
+    { "rshift",2,1}, { "lshift",2,1}, { "max",  2,1 }, { "min",  2,1 }, { "2*",   1,1 },
+    { "2/",   1,1 }, { "1+",   1,1 }, { "1-",   1,1 }, { "int",  1,1 }, { "0=",   1,1 },
+    { "0<",   1,1 }, { "0>",   1,1 }, { "=",    2,1 }, { ">",    2,1 }, { "<",    2,1 },
+    { "<>",   2,1 }, { ">=",   2,1 }, { "<=",   2,1 }, { "u<",   2,1 }, { "u>",   2,1 },
+    { "case!",1,0 }, { "base", 0,1 }, { "decimal",0,0}, { "hex", 0,0 }, { "bl",   0,1 },
+    { "cr",   0,0 }, { ".",    1,0 }, { "u.",   1,0 }, { ".r",   2,0 }, { "u.r",  2,0 },
+    { "type", 2,0 }, { "emit", 1,0 }, { "space",0,0 }, { "spaces",1,0}, { "@",    1,1 },
+    { "!",    2,0 }, { ",",    1,0 }, { "cells",1,1 }, { "allot",1,0 }, { "th",   2,1 },
+    { "+!",   2,0 }, { "?",    1,0 }, { "cmove",3,0 }, { "move", 3,0 }, { "fill", 3,0 },
+    { "v+",   4,0 }, { "v*",   4,0 }, { "vscale",4,0}, { "vdot", 3,1 }, { "vsum", 2,1 },
+    { "vmin", 2,1 }, { "vmax", 2,1 }, { "here", 0,1 }, { "depth",0,1 }, { "ms",   0,1 },
+    { "rnd",  0,1 }, { "delay",1,0 }, { "spawn",2,1 }, { "yield",0,0 }, { "join", 1,1 },
+    { "i",    0,1 }, { "r@",   0,1 }, { "r",    0,1 }, { ">r",   1,0, 1 }, { "r>", 0,1, -1 },
+    { "exit", 0,0, 0, 1 }, { "leave", 0,0, -2, 1 }
+};
+#define SFX_NC  (sizeof(sfx_code) / sizeof(SfxCode))
+#define SFX_XT  256                    /**< xt offset => sfx_code, power of 2 */
+struct { IU xt; U8 i; } sfx_xt[SFX_XT];  ///< i: sfx_code index + 1, 0: empty
+#define SFX_SLOT(pfa) (vm->_sfx[((pfa) / sizeof(IU)) & (E4_SFX_TAB - 1)])
+
+void sfx_init() {                      ///< hash built-ins by token, once
+    for (U32 i = 0; i < SFX_NC; i++) {
+        IU w = find(sfx_code[i].name);
+        if (!w) continue;              /// * i.e. no spawn on WASM
+        IU xt = VM_DICT()[w].xti(), h = xt & (SFX_XT - 1);
+        while (sfx_xt[h].i) h = (h + 1) & (SFX_XT - 1);
+        sfx_xt[h] = { xt, (U8)(i + 1) };
+    }
+}
+SfxCode *sfx_find(IU xt) {
+    for (IU h = xt & (SFX_XT - 1); sfx_xt[h].i; h = (h + 1) & (SFX_XT - 1)) {
+        if (sfx_xt[h].xt == xt) return &sfx_code[sfx_xt[h].i - 1];
+    }
+    return 0;
+}
+void sfx_flush(IU p) {                 ///< forget words from pmem offset p on
+    for (int i = 0; i < E4_SFX_TAB; i++) {
+        if (vm->_sfx[i].pfa >= p) vm->_sfx[i] = { 0, 0, 0, 0, 0 };
+    }
+}
+///
+///> infer stack effect of dict[w], keep it if known
+///
+void sfx_word(IU w) {
+    IU pfa = VM_DICT()[w].pfa;
+    IU p1  = (int)(w+1) < VM_DICT().idx             ///< end of word
+        ? VM_DICT()[w+1].pfa - STRLEN(VM_DICT()[w+1].name) : HERE;
+    const int NA = 0x7fff;                          ///< no path here yet
+    vector<S32> at(p1 - pfa + 1, NA);               ///< d | r << 16 at each token
+    vector<IU>  todo { pfa };
+    int lo = 0, hi = 0, rh = 0, net = NA;
+    at[0] = 0;
+    auto fx = [&]() {                               ///< 0: effect not known
+        while (todo.size()) {
+            IU  pc = todo.back(); todo.pop_back();
+            int d  = (int16_t)(at[pc - pfa] & 0xffff), r = at[pc - pfa] >> 16;
+            while (true) {
+                IU  ix = IGET(pc), nx = pc + op_len(pc), t = 0;  ///< t: branch target
+                int tr = r;                          ///< rs depth at t
+                auto take = [&](int in, int out) { lo = min(lo, d - in); d += out - in; };
+                auto ret  = [&]() {                  /// * path returns
+                    if (r) return false;
+                    if (net == NA) net = d;
+                    return net == d;
+                };
+                switch (ix) {
+                case NOP:   break;
+                case EXIT:  if (!ret()) return 0; goto done;
+                case LIT:   take(0, 1);              break;
+                case STR:   take(0, 2);              break;
+                case DOTQ:                           break;
+                case KEY:   take(0, 1);              break;
+                case VAR:   take(0, 1); if (!ret()) return 0; goto done;
+                case LADD:  case RADD: take(1, 1);   break;
+                case OVADD: take(2, 2);              break;
+                case FOR:   take(1, 0); r += 1;      break;
+                case DO:    take(2, 0); r += 2;      break;
+                case ZBRAN: take(1, 0); t = IGET(pc + sizeof(IU));     break;
+                case DZBRAN:take(1, 1); t = IGET(pc + 3 * sizeof(IU)); break;
+                case NEXT:  case INEXT:
+                    if (ix==INEXT) take(1, 1);
+                    if (r < 1) return 0;
+                    t = IGET(pc + (ix==NEXT ? 1 : 2) * sizeof(IU)); r -= 1;
+                    break;
+                case LOOP:
+                    if (r < 2) return 0;
+                    t = IGET(pc + sizeof(IU)); r -= 2;
+                    break;
+                case BRAN:
+                    t = IGET(pc + sizeof(IU));
+                    if (t >= pfa && t < p1) { nx = t; t = 0; break; }
+                    ix = t | EXT_FLAG;               /// * tail call, see fuse
+                    /* no break */
+                default:
+                    if (IS_PRIM(ix)) return 0;       /// * VBRAN, DOES
+                    if (ix & EXT_FLAG) {             /// * colon word, known?
+                        SfxEnt &e = SFX_SLOT(ix & ~EXT_FLAG);
+                        if (e.pfa != (ix & ~EXT_FLAG)) return 0;
+                        lo = min(lo, d + e.lo);
+                        hi = max(hi, d + e.hi);
+                        rh = max(rh, r + 1 + e.rh);
+                        d += e.net;
+                        if (IGET(pc)==BRAN) { if (!ret()) return 0; goto done; }
+                        break;
+                    }
+                    SfxCode *c = sfx_find(ix);
+                    if (!c) return 0;
+                    take(c->in, c->out); r += c->r;
+                    if (r < 0) return 0;
+                    if (c->end) { if (!ret()) return 0; goto done; }
+                }
+                hi = max(hi, d); rh = max(rh, r);
+                if (d < -64 || hi > 64 || rh > 64) return 0;
+                auto go = [&](IU p, int pr) {        /// * flow into p
+                    if (p < pfa || p >= p1) return false;
+                    S32 s = (d & 0xffff) | (pr << 16), &a = at[p - pfa];
+                    if (a == NA) { a = s; todo.push_back(p); }
+                    return a == s;
+                };
+                if (t && !go(t, tr)) return 0;
+                if (nx >= p1) return 0;              /// * ran off the end
+                S32 s = (d & 0xffff) | (r << 16), &a = at[nx - pfa];
+                if (a != NA) { if (a != s) return 0; break; }   /// * joined a known path
+                a = s; pc = nx;
+            }
+        done: ;
+        }
+        return net != NA ? 1 : 0;
+    };
+    SfxEnt &e = SFX_SLOT(pfa);
+    if (fx()) e = { pfa, (S8)lo, (S8)hi, (S8)rh, (S8)net };
+    else if (e.pfa == pfa) e.pfa = 0;
+}
+///
+///> check a word at entry, sd/rd: ss/rs depth after the call frame is set
+///  return 1: known and fits, 0: not known, <0: sfx_err code
+///
+int sfx_enter(IU pfa, int sd, int rd) {
+    SfxEnt &e = SFX_SLOT(pfa);
+    if (e.pfa != pfa)            return 0;
+    if (sd + e.lo < 0)           return -1;
+    if (sd + e.hi > VM_SS().sz)       return -2;
+    if (rd + e.rh > VM_RS().sz)       return -3;
+    return 1;
+}
+void sfx_err(int e) {                  ///< abort on stack error, 0: find out from task
+    if (!e) e = VM_SS().idx < 0 ? -1 : VM_SS().idx > VM_SS().sz - E4_SFX_MARGIN ? -2
+              : VM_RS().idx < 0 ? -4 : -3;
+    stk_err(e);
+}
+#define SFX_WORD(w)  sfx_word(w)
+#else  // !DO_SCHECK
+void sfx_init()  {}
+#define SFX_WORD(w)
+#endif // DO_SCHECK
+///@}
+///====================================================================
+///
+///@name Per-word profiler (DO_PROFILE in config.h)
+///@brief
+///    * a shadow frame stack follows colon words by return stack depth,
+///    * so every UNNEST path (;, exit, leave, var, does>) closes them
+///    * built-in frames are closed right after Code::exec() returns
+///    * exclusive = inclusive - time spent in callees
+///@{
+#if DO_PROFILE
+int pfa2didx(IU ix);                   ///< reverse lookup (see Debug functions)
+
+struct Prof {                          ///< per dict entry counters
+    U32 n;                             ///< number of calls
+    U64 t_in;                          ///< inclusive time (ns)
+    U64 t_ex;                          ///< exclusive time (ns)
+} prof[E4_DICT_SZ];
+struct ProfFrame {
+    IU  w;                             ///< dict index
+    int rp;                            ///< rs depth at entry, -1 for built-in
+    U64 t0;                            ///< entry time
+    U64 tc;                            ///< time spent in callees
+} pfrm[E4_RS_SZ * 2];
+int  pdp     = 0;                      ///< shadow frame depth
+bool prof_on = false;                  ///< profiler switch
+#define PROF_ON (prof_on && tk==vm)    /**< main task only, spawned tasks not profiled */
+
+void prof_enter(IU w, int rp) {
+    if (!PROF_ON || !w || pdp >= (int)(sizeof(pfrm)/sizeof(ProfFrame))) return;
+    pfrm[pdp++] = { w, rp, nanos(), 0 };
+}
+void prof_close() {                    ///< close top frame
+    ProfFrame &f = pfrm[--pdp];
+    U64  dt = nanos() - f.t0;
+    Prof &p = prof[f.w];
+    p.n++; p.t_in += dt; p.t_ex += dt - f.tc;
+    if (pdp) pfrm[pdp-1].tc += dt;     /// * charge caller
+}
+void prof_exit() {                     ///< colon words returned (UNNEST)
+    while (pdp && pfrm[pdp-1].rp > VM_RS().idx) prof_close();
+}
+void prof_leave(int dp) {              ///< built-in returned
+    while (pdp > dp) prof_close();
+    prof_exit();                       /// * built-in may have unnested (exit, leave)
+}
+#define PROF_COLON(ix) prof_enter(PROF_ON ? pfa2didx(ix) : 0, VM_RS().idx)
+#define PROF_CODE(ix, g) {                   \
+    int _dp = pdp;                           \
+    prof_enter(PROF_ON ? pfa2didx(ix) : 0, -1); \
+    g;                                       \
+    if (PROF_ON) prof_leave(_dp);            \
+    }
+#define PROF_EXIT()    (PROF_ON ? prof_exit() : (void)0)
+
+void prof_start() {
+    for (int i = 0; i < E4_DICT_SZ; i++) prof[i] = { 0, 0, 0 };
+    pdp = 0; prof_on = true;
+}
+#else  // !DO_PROFILE
+#define PROF_COLON(ix)
+#define PROF_CODE(ix, g) { g; }
+#define PROF_EXIT()      ((void)0)
+#endif // DO_PROFILE
+///@}
+///====================================================================
+///
+///@name Baseline JIT - hot colon words to x86-64 code (DO_JIT in config.h)
+///@brief
+///    * colon calls are counted per pfa, a word called E4_JIT_HOT times
+///      is translated once into subroutine threaded code: lit, for, next
+///      and 0branch work on the task (in rbx) directly, built-ins and small
+///      helpers are called, branches and loops become jumps
+///    * tokens it does not translate (colon calls, var, strings, does>,
+///      key) bail out: IP is set to the token and nest() carries on,
+///      as it does after a built-in leaves VM!=NEST or moves IP
+///    * only the VM's main task runs JIT code, so tk is a constant
+///    * dict_clear (forget, boot, load-image), is and to flush the code,
+///      the buffer is reused once no JIT frame is left on the C stack
+///    * W^X: the buffer is RW only while jit_compile emits (a flush just
+///      rewinds it, the next compile makes it writable again) and RX
+///      before any code runs, running frames are never left on RW pages
+///@{
+#if DO_JIT
+int pfa2didx(IU ix);                   ///< reverse lookup (see Debug functions)
+
+#define JIT_ORG    16                  /**< _jbuf offset 0 means not compiled  */
+#define JIT_TOK    128                 /**< max code bytes per token, bail included */
+#define JIT_NEVER  0xffff              /**< JitEnt.n, word not worth compiling */
+#define JIT_MAIN   (tk==vm)            /**< main task only, see nest()          */
+///
+///> helpers called from JIT code, with tk==vm (main task)
+///
+void j_ladd(U32 b) { DU v; memcpy(&v, &b, sizeof(DU)); VM_TOS() += v; }
+void j_ovadd()     { VM_TOS() += VM_SS()[-1]; }
+void j_radd()      { VM_TOS() += VM_RS()[-1]; }
+void j_inc()       { VM_TOS() += DU1; }
+void j_do()        { VM_RS().push(VM_SS().pop()); VM_RS().push(POP()); }
+void j_exit()      { VM_ST() = (VM_IP() = UINT(VM_RS().pop())) ? HOLD : STOP; }
+int  j_dzbran()    { return ZEQ(VM_TOS()) ? 1 : 0; }        ///< 0: take branch
+int  j_loop() {                                             ///< 1: loop back
+    if (GT(VM_RS()[-2], VM_RS()[-1] += DU1)) return 1;
+    VM_RS().pop(); VM_RS().pop(); return 0;
+}
+void jit_flush() {
+    for (int i = 0; i < E4_JIT_TAB; i++) vm->_jtab[i] = { 0, 0, 0 };
+    if (vm->_jdepth) vm->_jstale = true;           /// * still running, reuse later
+    else if (vm->_jhere > 0) vm->_jhere = JIT_ORG;
+}
+void jit_free(ForthVM *v) {
+    if (v->_jbuf) munmap(v->_jbuf, E4_JIT_SZ);
+    v->_jbuf = 0; v->_jhere = 0;
+}
+///
+///> translate the body of a colon word, return code offset or 0
+///
+U32 jit_compile(IU pfa) {
+    static_assert(sizeof(vm_state)==4 && sizeof(DU)==4, "dword ops below");
+    IU w  = IGET(pfa);
+    IU i0 = pfa2didx(pfa | EXT_FLAG);
+    if (!i0 || w==VAR || w==VBRAN || vm->_jhere < 0) return 0;   /// * data words stay
+    IU p1 = (int)(i0+1) < VM_DICT().idx             ///< end of word
+        ? VM_DICT()[i0+1].pfa - STRLEN(VM_DICT()[i0+1].name) : HERE;
+
+    if (!vm->_jbuf) {                               /// * map code buffer, never RWX
+        void *m = mmap(0, E4_JIT_SZ, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m==MAP_FAILED) { vm->_jhere = -1; return 0; } /// * interpret only
+        vm->_jbuf = (U8*)m; vm->_jhere = JIT_ORG;
+    }
+    int sz = (int)((p1 - pfa) / sizeof(IU) + 1) * JIT_TOK;
+    if (vm->_jhere + sz > E4_JIT_SZ) {              /// * full, start over
+        if (vm->_jdepth || sz > E4_JIT_SZ - JIT_ORG) return 0;
+        jit_flush();
+    }
+    auto o = [](void *a) { return (U32)((U8*)a - (U8*)vm); };     ///< task field offset
+    U32 o_ip = o(&VM_IP()),     o_vm = o(&VM_ST()),     o_tos = o(&VM_TOS());
+    U32 o_sv = o(&VM_SS().v),   o_si = o(&VM_SS().idx), o_sm  = o(&VM_SS().max);
+    U32 o_rv = o(&VM_RS().v),   o_ri = o(&VM_RS().idx), o_rm  = o(&VM_RS().max);
+
+    if (mprotect(vm->_jbuf, E4_JIT_SZ, PROT_READ | PROT_WRITE)) return 0; /// * W^X: writable while emitting
+    U8 *p0 = vm->_jbuf + vm->_jhere, *p = p0;
+    vector<U8*> lbl(p1 - pfa + 1, (U8*)0);          ///< pmem offset => code
+    vector<pair<U8*, IU>> fix;                      ///< forward jumps to patch
+    auto b1  = [&p](U8 v)  { *p++ = v; };
+    auto b4  = [&p](U32 v) { memcpy(p, &v, 4); p += 4; };
+    auto bn  = [&](initializer_list<U8> c) { for (U8 v : c) b1(v); };
+    auto iu  = [&](IU v)   { memcpy(p, &v, sizeof(IU)); p += sizeof(IU); };
+    auto rbx = [&](U8 op, int r, U32 d) {           /// op r32, [rbx+d]
+        b1(op); b1(0x83 | (r << 3)); b4(d);
+    };
+    auto call = [&](UFP f) {                        /// mov rax, f; call rax
+        b1(0x48); b1(0xb8); memcpy(p, &f, 8); p += 8; bn({ 0xff, 0xd0 });
+    };
+    auto jcc  = [&](U8 cc, U8 *t) {                 /// jmp/jcc rel32, cc=0: jmp
+        if (cc) bn({ 0x0f, cc }); else b1(0xe9);
+        b4((U32)(t - (p + 4)));
+    };
+    auto jto  = [&](U8 cc, IU t) {                  /// jump to pmem target
+        U8 *x = (t >= pfa && t < p1) ? lbl[t - pfa] : 0;
+        if (x) { jcc(cc, x); return; }
+        jcc(cc, p);                                 /// * patched below
+        fix.push_back({ p - 4, t });
+    };
+    auto setip = [&](IU ip) {                       /// mov word/dword [rbx+IP], ip
+        if (sizeof(IU)==2) b1(0x66);
+        rbx(0xc7, 0, o_ip); iu(ip);
+    };
+    U8 *ret = p0 + 13;                              ///< pop rbx; ret
+    auto bail = [&](IU ip) { setip(ip); jcc(0, ret); };
+    auto pop  = [&]() {                             /// ecx = tos, tos = ss.pop()
+        rbx(0x8b, 1, o_tos);                        /// mov ecx, [tos]
+        rbx(0x8b, 0, o_si); bn({ 0xff, 0xc8 });    /// mov eax, [ss.idx]; dec eax
+        rbx(0x89, 0, o_si); b1(0x48); rbx(0x8b, 2, o_sv);  /// mov [ss.idx], eax; mov rdx, [ss.v]
+        bn({ 0x8b, 0x14, 0x82 }); rbx(0x89, 2, o_tos);     /// mov edx, [rdx+rax*4]; mov [tos], edx
+    };
+    auto push = [&](U32 v, U32 vi, U32 mi) {        /// List.push(ecx)
+        rbx(0x8b, 0, vi); b1(0x48); rbx(0x8b, 2, v);       /// mov eax, [idx]; mov rdx, [v]
+        bn({ 0x89, 0x0c, 0x82 }); rbx(0x89, 0, mi);        /// mov [rdx+rax*4], ecx; mov [max], eax
+        bn({ 0xff, 0xc0 }); rbx(0x89, 0, vi);              /// inc eax; mov [idx], eax
+    };
+    auto next = [&](IU t) {                         /// FOR_NEXT, rs[-1] -= 1
+        rbx(0x8b, 0, o_ri); b1(0x48); rbx(0x8b, 2, o_rv);  /// mov eax, [rs.idx]; mov rdx, [rs.v]
+#if USE_FLOAT
+        bn({ 0xf3, 0x0f, 0x10, 0x44, 0x82, 0xfc }); /// movss xmm0, [rdx+rax*4-4]
+        b1(0xb9); b4(0x3f800000);                   /// mov ecx, 1.0f
+        bn({ 0x66, 0x0f, 0x6e, 0xc9 });             /// movd xmm1, ecx
+        bn({ 0xf3, 0x0f, 0x5c, 0xc1 });             /// subss xmm0, xmm1
+        bn({ 0xf3, 0x0f, 0x11, 0x44, 0x82, 0xfc }); /// movss [rdx+rax*4-4], xmm0
+        bn({ 0xf3, 0x0f, 0x58, 0xc1 });             /// addss xmm0, xmm1, i.e. - -DU1
+        DU e = DU_EPS; U32 eb; memcpy(&eb, &e, 4);
+        b1(0xb9); b4(eb);                           /// mov ecx, DU_EPS
+        bn({ 0x66, 0x0f, 0x6e, 0xc9 });             /// movd xmm1, ecx
+        bn({ 0x0f, 0x2f, 0xc1 });                   /// comiss xmm0, xmm1
+        jto(0x87, t);                               /// ja: GT, loop back
+#else  // !USE_FLOAT
+        bn({ 0xff, 0x4c, 0x82, 0xfc });             /// dec dword [rdx+rax*4-4]
+        jto(0x89, t);                               /// jns: > -1, loop back
+#endif // USE_FLOAT
+        bn({ 0xff, 0xc8 }); rbx(0x89, 0, o_ri);    /// rs.pop()
+    };
+    bn({ 0x53, 0x48, 0xbb });                       /// push rbx (aligns rsp)
+    { UFP t = (UFP)tk; memcpy(p, &t, 8); p += 8; }  /// mov rbx, tk
+    bn({ 0xeb, 0x02, 0x5b, 0xc3 });                 /// jmp body; ret: pop rbx; ret
+    for (IU pc = pfa; pc < p1; ) {
+        IU ix = IGET(pc), nx = pc + op_len(pc);
+        U32 v;
+        lbl[pc - pfa] = p;
+        switch (ix) {
+        case NOP:    break;
+        case EXIT:   call((UFP)j_exit); jcc(0, ret);         break;
+        case LIT:
+            memcpy(&v, &CELL(DALIGN(pc + sizeof(IU))), sizeof(DU));
+            rbx(0x8b, 1, o_tos); push(o_sv, o_si, o_sm);    /// ss.push(tos)
+            rbx(0xc7, 0, o_tos); b4(v);                     /// tos = v
+            break;
+        case LADD:
+            memcpy(&v, &CELL(DALIGN(pc + sizeof(IU))), sizeof(DU));
+            b1(0xbf); b4(v);                                /// mov edi, v
+            call((UFP)j_ladd);                              break;
+        case OVADD:  call((UFP)j_ovadd);                     break;
+        case RADD:   call((UFP)j_radd);                      break;
+        case FOR:    pop(); push(o_rv, o_ri, o_rm);          break;
+        case DO:     call((UFP)j_do);                        break;
+        case BRAN:   jto(0, IGET(pc + sizeof(IU)));          break;
+        case ZBRAN:
+            pop();
+            bn({ USE_FLOAT ? (U8)0x01 : (U8)0x85, 0xc9 });  /// add ecx, ecx (drops -0.0) | test ecx, ecx
+            jto(0x84, IGET(pc + sizeof(IU)));               break;
+        case NEXT:   next(IGET(pc + sizeof(IU)));            break;
+        case LOOP:
+            call((UFP)j_loop); bn({ 0x85, 0xc0 });          /// test eax, eax
+            jto(0x85, IGET(pc + sizeof(IU)));               break;
+        case INEXT:
+            call((UFP)j_inc); next(IGET(pc + 2 * sizeof(IU)));  break;
+        case DZBRAN:
+            call((UFP)j_dzbran); bn({ 0x85, 0xc0 });
+            jto(0x84, IGET(pc + 3 * sizeof(IU)));           break;
+        case VAR: case VBRAN: case DOES:            /// * data or does> code follows
+            bail(pc); nx = p1;                              break;
+        default:
+            if (ix & EXT_FLAG) { bail(pc); break; } /// * STR, DOTQ, KEY, colon words
+            setip(nx);                              /// * built-ins may read IP
+            call((UFP)Code::XT(ix));
+            rbx(0x83, 7, o_vm); b1(NEST);           /// cmp dword [VM], NEST
+            jcc(0x85, ret);
+            if (sizeof(IU)==2) b1(0x66);
+            rbx(0x81, 7, o_ip); iu(nx);             /// cmp word/dword [IP], nx
+            jcc(0x85, ret);                         /// * IP moved, i.e. included
+        }
+        pc = nx;
+    }
+    bail(p1);                                       /// * ran off the end
+    for (auto &f : fix) {                           /// * resolve forward jumps
+        IU  t = f.second;
+        U8 *x = (t >= pfa && t < p1) ? lbl[t - pfa] : 0;
+        if (!x) { x = p; bail(t); }                 /// * not a token here, interpret
+        U32 r = (U32)(x - (f.first + 4));
+        memcpy(f.first, &r, 4);
+    }
+    U32 off = (U32)(p0 - vm->_jbuf);
+    vm->_jhere = (int)(p - vm->_jbuf);
+    if (mprotect(vm->_jbuf, E4_JIT_SZ, PROT_READ | PROT_EXEC)) { /// * then executable, not writable
+        jit_flush(); vm->_jhere = -1;               /// * no exec memory, interpret only
+        return 0;
+    }
+    return off;
+}
+///
+///> count a colon call, compile when hot, return code if any
+///
+FPTR jit_code(IU pfa) {
+    JitEnt &e = vm->_jtab[(pfa / sizeof(IU)) & (E4_JIT_TAB - 1)];
+    if (e.pfa != pfa) e = { pfa, 0, 0 };            /// * evict
+    if (!e.off) {
+        if (e.n==JIT_NEVER || ++e.n < E4_JIT_HOT) return 0;
+        U32 off = jit_compile(pfa);                 /// * may flush the table
+        e = { pfa, (U16)(off ? E4_JIT_HOT : JIT_NEVER), off };
+        if (!off) return 0;
+    }
+    return (FPTR)(vm->_jbuf + e.off);
+}
+FPTR jit_find(IU pfa) {                            ///< no counting, i.e. nest() entry
+    JitEnt &e = vm->_jtab[(pfa / sizeof(IU)) & (E4_JIT_TAB - 1)];
+    return (e.pfa==pfa && e.off) ? (FPTR)(vm->_jbuf + e.off) : 0;
+}
+void jit_run(FPTR f) {                             ///< IP set to where nest() resumes
+    vm->_jdepth++;
+    f();
+    if (!--vm->_jdepth && vm->_jstale) {           /// * flushed while running
+        vm->_jstale = false;
+        jit_flush();
+    }
+}
+#endif // DO_JIT
 ///@}
 ///====================================================================
 ///
@@ -212,106 +1206,456 @@ void s_quote(prim_op op) {
 ///  * use of cached _NXT address speeds up 10% on AMD but
 ///    5% slower on ESP32 probably due to shallow pipeline
 ///  * computed label runs 15% faster, but needs long macros (for enum)
+///    (see DO_CGOTO in config.h, WASM has no labels-as-values so switch is kept)
 ///  * use local stack speeds up 10%, but allot 4*64 bytes extra
+///  * IP, tos and stack tops kept in locals (DO_LREG), dispatch.fs 10 => 7.7ns
 ///
 ///  TODO: performance tuning
 ///    1. Just-in-time cache(ip, dp)
 ///    2. Co-routine
 ///
+#if DO_LREG
+///
+///> nest() keeps IP, tos and stack tops in locals (see DO_LREG in config.h)
+///  written back by LR_SAVE before a built-in runs and when nest() returns,
+///  reloaded by LR_LOAD afterwards, since built-ins work on the task itself
+///  LR_SAVE also raises ss.max and rs.max, which the local pushes skip
+///
+#define _IP          ip
+#define _TOS         t
+#define SPUSH(v)     (*sp++ = (v))
+#define SPOP()       (*--sp)
+#define SS(i)        (sp[i])
+#define RPUSH(v)     (*rp++ = (v))
+#define RPOP()       (*--rp)
+#define RDROP()      (--rp)
+#define RS(i)        (rp[i])
+#define LR_MAX(s, i) ((s).max = (i) > (s).max ? (i) : (s).max)   /**< watermark, as push keeps it */
+#define LR_SAVE()    (VM_IP() = ip, VM_TOS() = t,                              \
+                      VM_SS().idx = (int)(sp - VM_SS().v), LR_MAX(VM_SS(), VM_SS().idx - 1), \
+                      VM_RS().idx = (int)(rp - VM_RS().v), LR_MAX(VM_RS(), VM_RS().idx - 1))
+#define LR_LOAD()    (ip = VM_IP(), t = VM_TOS(), sp = VM_SS().v + VM_SS().idx, rp = VM_RS().v + VM_RS().idx)
+#define _POP()       (n = t, t = *--sp, n)
+#define SS_IDX()     ((int)(sp - VM_SS().v))
+#define RS_IDX()     ((int)(rp - VM_RS().v))
+#else  // !DO_LREG
+#define _IP          VM_IP()
+#define _TOS         VM_TOS()
+#define SPUSH(v)     VM_SS().push(v)
+#define SPOP()       VM_SS().pop()
+#define SS(i)        VM_SS()[i]
+#define RPUSH(v)     VM_RS().push(v)
+#define RPOP()       VM_RS().pop()
+#define RDROP()      VM_RS().pop()
+#define RS(i)        VM_RS()[i]
+#define LR_SAVE()    ((void)0)
+#define LR_LOAD()    ((void)0)
+#define _POP()       POP()
+#define SS_IDX()     (VM_SS().idx)
+#define RS_IDX()     (VM_RS().idx)
+#endif // DO_LREG
+#if DO_SCHECK
+#define SCHK()       if (chk && ((U32)SS_IDX() > (U32)(VM_SS().sz - E4_SFX_MARGIN) ||  \
+                                 (U32)RS_IDX() > (U32)(VM_RS().sz - E4_SFX_MARGIN))) { \
+                         LR_SAVE(); sfx_err(0); return;                           \
+                     }
+#define UNCHECKED    (!chk)
+#else  // !DO_SCHECK
+#define SCHK()
+#define UNCHECKED    1
+#endif // DO_SCHECK
+#if DO_TRACE
+///
+///> flight recorder, one record per op into the task's ring, no lock
+///  since only the task itself writes it, readers take _tr_n first
+///
+#define TRACE(ip, op) {                                                 \
+        TraceRec &r_ = tk->_tr[tk->_tr_n & (E4_TRACE_SZ - 1)];          \
+        r_ = { (IU)(ip), (IU)(op), _TOS, (S16)SS_IDX(), (S16)RS_IDX() }; \
+        tk->_tr_n++;                                                    \
+    }
+#else  // !DO_TRACE
+#define TRACE(ip, op)
+#endif // DO_TRACE
+#define _PUSH(v)     (SPUSH(_TOS), _TOS = (v))
+#if DO_CGOTO
+#define DISPATCH(op) goto *_op[IS_PRIM(op) ? ((op) & ~EXT_FLAG) : (MAX_OP & ~EXT_FLAG)];
+#define CASE(op, g)  L_##op : { g; } _NEXT()
+#define OTHER(g)     L_OTHER: { g; } _NEXT()
+#define _NEXT()      if (VM_ST()!=NEST || !_IP) { LR_SAVE(); return; } \
+                     SCHK(); ix = IGET(_IP); TRACE(_IP, ix);   \
+                     _IP += sizeof(IU); DISPATCH(ix)
+#else  // !DO_CGOTO
 #define DISPATCH(op) switch(op)
 #define CASE(op, g)  case op : { g; } break
 #define OTHER(g)     default : { g; } break
-#define UNNEST()     (VM = (IP=UINT(rs.pop())) ? HOLD : STOP)
+#endif // DO_CGOTO
+#define UNNEST()     (VM_ST() = (VM_IP()=UINT(VM_RS().pop())) ? HOLD : STOP, PROF_EXIT())
+#define _UNNEST()    (VM_ST() = (_IP=UINT(RPOP())) ? HOLD : STOP, PROF_EXIT())
+#define FOR_NEXT()   if (GT(RS(-1) -= DU1, -DU1)) _IP = IGET(_IP); /** loop back */ \
+                     else { RDROP(); _IP += sizeof(IU); }         /** loop done */
 
 void nest() {
-    VM = NEST;                                       /// * activate VM
-    while (VM==NEST && IP) {
-        IU ix = IGET(IP);                            ///< fetched opcode, hopefully in register
-//        printf("[%4x]:%4x", IP, ix);
-        IP += sizeof(IU);
+#if DO_CGOTO
+    static void *_op[] = {                           ///< jump table, in prim_op order
+        &&L_EXIT, &&L_NOP,  &&L_NEXT,  &&L_LOOP,  &&L_LIT,  &&L_VAR, &&L_STR, &&L_DOTQ,
+        &&L_BRAN, &&L_ZBRAN,&&L_VBRAN, &&L_DOES,  &&L_FOR,  &&L_DO,  &&L_KEY,
+        &&L_LADD, &&L_OVADD,&&L_RADD,  &&L_DZBRAN,&&L_INEXT,&&L_OTHER
+    };
+    static_assert(sizeof(_op)/sizeof(void*) == (MAX_OP & ~EXT_FLAG) + 1,
+                  "nest() jump table out of sync with prim_op");
+#endif // DO_CGOTO
+    Task *tk = ::tk;                                 ///< current task, cached off TLS
+#if DO_LREG
+    IU  ip; DU t, n; DU *sp, *rp;                    ///< hot state, in registers hopefully
+    LR_LOAD();
+#endif // DO_LREG
+    VM_ST() = NEST;                                  /// * activate VM
+#if DO_SCHECK
+    int  e   = sfx_enter(_IP, SS_IDX(), RS_IDX());   ///< CALL into a known word?
+    if (e < 0) { TRACE(_IP, _IP | EXT_FLAG); LR_SAVE(); sfx_err(e); return; } /// * rejected entry
+    bool chk = !e;                                   ///< check every op, i.e. on resume
+#endif // DO_SCHECK
+#if DO_JIT
+    FPTR f = (JIT_MAIN && UNCHECKED) ? jit_find(_IP) : 0; /// * CALL into a compiled word
+    if (f) { LR_SAVE(); jit_run(f); LR_LOAD(); }
+#endif // DO_JIT
+    while (VM_ST()==NEST && _IP) {
+        SCHK();
+        IU ix = IGET(_IP);                           ///< fetched opcode, hopefully in register
+        TRACE(_IP, ix);                              /// * see .trace
+        _IP += sizeof(IU);
         DISPATCH(ix) {                               /// * opcode dispatcher
-        CASE(EXIT, UNNEST());
+        CASE(EXIT, _UNNEST());
         CASE(NOP,  { /* do nothing */});
-        CASE(NEXT,
-             if (GT(rs[-1] -= DU1, -DU1)) {          ///> loop done?
-                 IP = IGET(IP);                      /// * no, loop back
-             }
-             else {                                  /// * yes, loop done!
-                 rs.pop();                           /// * pop off loop counter
-                 IP += sizeof(IU);                   /// * next instr.
-             });
+        CASE(NEXT, FOR_NEXT());
         CASE(LOOP,
-             if (GT(rs[-2], rs[-1] += DU1)) {        ///> loop done?
-                 IP = IGET(IP);                      /// * no, loop back
+             if (GT(RS(-2), RS(-1) += DU1)) {        ///> loop done?
+                 _IP = IGET(_IP);                    /// * no, loop back
              }
              else {                                  /// * yes, done
-                 rs.pop(); rs.pop();                 /// * pop off counters
-                 IP += sizeof(IU);                   /// * next instr.
+                 RDROP(); RDROP();                   /// * pop off counters
+                 _IP += sizeof(IU);                  /// * next instr.
              });
         CASE(LIT,
-             ss.push(tos);
-             tos = *(DU*)MEM(IP);                    ///> from hot cache, hopefully
-             IP += sizeof(DU));                      /// * hop over the stored value
-        CASE(VAR, PUSH(DALIGN(IP)); UNNEST());       ///> get var addr, alignment?
+             SPUSH(_TOS);
+             _IP  = DALIGN(_IP);                     /// * skip padding, see add_du
+             _TOS = CELL(_IP);                       ///> from hot cache, hopefully
+             _IP += sizeof(DU));                     /// * hop over the stored value
+        CASE(VAR, _PUSH(DALIGN(_IP)); _UNNEST());    ///> get var addr, alignment?
         CASE(STR,
-             const char *s = (const char*)MEM(IP);   ///< get string pointer
+             const char *s = (const char*)MEM(_IP);  ///< get string pointer
              IU    len = STRLEN(s);
-             PUSH(IP); PUSH(len); IP += len);
+             _PUSH(_IP); _PUSH(len); _IP += len);
         CASE(DOTQ,                                   /// ." ..."
-             const char *s = (const char*)MEM(IP);   ///< get string pointer
-             pstr(s);  IP += STRLEN(s));             /// * send to output console
-        CASE(BRAN, IP = IGET(IP));                   /// * unconditional branch
+             const char *s = (const char*)MEM(_IP);  ///< get string pointer
+             pstr(s);  _IP += STRLEN(s));            /// * send to output console
+        CASE(BRAN, _IP = IGET(_IP));                 /// * unconditional branch
         CASE(ZBRAN,                                  /// * conditional branch
-             IP = POP() ? IP+sizeof(IU) : IGET(IP));
+             _IP = _POP() ? _IP+sizeof(IU) : IGET(_IP));
         CASE(VBRAN,
-             PUSH(DALIGN(IP + sizeof(IU)));          /// * skip target address
-             if ((IP = IGET(IP))==0) UNNEST());      /// * jump target of does> if given
+             _PUSH(DALIGN(_IP + sizeof(IU)));        /// * skip target address
+             if ((_IP = IGET(_IP))==0) _UNNEST());   /// * jump target of does> if given
         CASE(DOES,
              IU *p = (IU*)MEM(LAST.pfa);             ///< memory pointer to pfa 
-             *(p+1) = IP;                            /// * encode current IP, and bail
-             UNNEST());
-        CASE(FOR,  rs.push(POP()));                  /// * setup FOR..NEXT call frame
+             *(p+1) = _IP;                           /// * encode current IP, and bail
+             _UNNEST());
+        CASE(FOR,  RPUSH(_POP()));                   /// * setup FOR..NEXT call frame
         CASE(DO,                                     /// * setup DO..LOOP call frame
-             rs.push(ss.pop()); rs.push(POP()));
-        CASE(KEY,  key(); VM = IO);                  /// * fetch single keypress
+             RPUSH(SPOP()); RPUSH(_POP()));
+        CASE(KEY,  LR_SAVE(); key(); LR_LOAD(); VM_ST() = IO); /// * fetch single keypress
+        CASE(LADD,                                   /// * lit +
+             _IP   = DALIGN(_IP);
+             _TOS += CELL(_IP);
+             _IP  += sizeof(DU) + sizeof(IU));
+        CASE(OVADD, _TOS += SS(-1); _IP += sizeof(IU));  /// * over +
+        CASE(RADD,  _TOS += RS(-1); _IP += sizeof(IU));  /// * r@ +, i +
+        CASE(DZBRAN,                                 /// * dup 0= 0bran
+             _IP += 2 * sizeof(IU);
+             _IP  = ZEQ(_TOS) ? _IP+sizeof(IU) : IGET(_IP));
+        CASE(INEXT,                                  /// * 1+ next
+             _TOS += DU1; _IP += sizeof(IU); FOR_NEXT());
         OTHER(
             if (ix & EXT_FLAG) {                     /// * colon word?
-                rs.push(IP);                         /// * setup call frame
-                IP = ix & ~EXT_FLAG;                 /// * IP = word.pfa
+                RPUSH(_IP);                          /// * setup call frame
+                PROF_COLON(ix);
+                _IP = ix & ~EXT_FLAG;                /// * IP = word.pfa
+#if DO_SCHECK
+                int e = sfx_enter(_IP, SS_IDX(), RS_IDX());  ///< known: one check here
+                if (e < 0) { LR_SAVE(); sfx_err(e); return; } /// * the call is in the ring already
+                chk = !e;
+#endif // DO_SCHECK
+#if DO_JIT
+                FPTR f = (JIT_MAIN && UNCHECKED) ? jit_code(_IP) : 0;
+                if (f) { LR_SAVE(); jit_run(f); LR_LOAD(); }  /// * hot word, IP where it bailed
+#endif // DO_JIT
             }
-            else Code::exec(ix));                    ///> execute built-in word
+            else {
+                LR_SAVE();                           /// * built-ins work on the task
+                PROF_CODE(ix, Code::exec(ix));       ///> execute built-in word
+                LR_LOAD();
+            });
         }
-//        printf("   => IP=%4x, rs.idx=%d, VM=%d\n", IP, rs.idx, VM);
+//        printf("   => IP=%4x, rs.idx=%d, VM=%d\n", _IP, rs.idx, VM);
     }
+    LR_SAVE();                                       /// * hand state back to the task
 }
 ///
 ///> CALL - inner-interpreter proxy (inline macro does not run faster)
 ///
 void CALL(IU w) {
     if (IS_UDF(w)) {                   /// colon word
-        rs.push(DU0);
-        IP = dict[w].pfa;              /// setup task context
+        VM_RS().push(DU0);
+        VM_IP() = DICT_PFA(w);         /// setup task context
+        PROF_COLON(VM_IP() | EXT_FLAG);
+#if DO_JIT
+        if (JIT_MAIN) jit_code(VM_IP()); /// count, nest() runs it
+#endif // DO_JIT
         nest();
     }
-    else dict[w].call();               /// built-in word
+    else PROF_CODE(DICT_PFA(w), Code::exec(DICT_PFA(w))); /// built-in word
 }
 ///
 ///> Forth script loader
 ///
 void load(const char* fn) {
-    load_dp++;                            /// * increment depth counter
-    rs.push(IP);                          /// * save context
-    VM = NEST;                            /// * +recursive
+    VM_LOADP()++;                         /// * increment depth counter
+    VM_RS().push(VM_IP());                /// * save context
+    VM_ST() = NEST;                       /// * +recursive
     forth_include(fn);                    /// * include file
-    IP = UINT(rs.pop());                  /// * restore context
-    --load_dp;                            /// * decrement depth counter
+    VM_IP() = UINT(VM_RS().pop());        /// * restore context
+    --VM_LOADP();                         /// * decrement depth counter
+}
+///====================================================================
+///
+///@name Task scheduler - spawn, yield, join on a worker thread pool
+///@brief
+///    * each worker owns a deque, it runs its newest task (back) and,
+///      when idle, steals the oldest task (front) of its peers
+///    * a task runs until done, yield, or its time slice (E4_SLICE ms)
+///      is up, then it is queued at front so its peers can run
+///    * tasks share dictionary and pmem of their VM, so they should
+///      not define words and shared variables are up to the program
+///@{
+#if DO_MULTITASK
+struct TaskQ {                          ///< per worker task deque
+    mutex        mx;
+    deque<Task*> q;
+};
+struct Sched {
+    int                n;               ///< number of workers
+    TaskQ              *qs;             ///< worker deques
+    vector<thread>     th;              ///< worker threads
+    atomic<int>        nrdy{0};         ///< number of queued tasks
+    atomic<U32>        rr{0};           ///< round-robin for host spawn
+    atomic<bool>       quit{false};     ///< pool shutdown
+    mutex              mx;              ///< idle lock
+    condition_variable cv;              ///< wake up idle workers
+
+    Sched();
+    ~Sched();
+    void  push(Task *t, bool front=false);
+    Task *take(int i);                  ///< i<0: host, steal only
+    void  worker(int i);
+};
+thread_local int wid = -1;              ///< worker id, -1 for host threads
+
+Sched &sched() {                        ///< pool is started on first spawn
+    static Sched s;
+    return s;
+}
+///
+///> run a task for one time slice on the current thread
+///
+void task_run(Task *t) {
+    ForthVM *v1 = vm;                   ///< keep caller's context
+    Task    *t1 = tk;
+    vm = t->_vm; tk = t;
+    long t0 = millis() + E4_SLICE;      ///< end of time slice
+    t->_yld = false;
+    STK_CATCH(e);                       ///< guard page hit, VM=STOP ends the task
+    if (e) stk_err(e);
+    if (VM_ST()==QUERY) { VM_ST() = STOP; CALL(t->_xt); } /// * first slice
+    while (VM_ST()==HOLD && !t->_yld && millis() < t0) { nest(); STK_CHECK(); }
+    STK_UNCATCH();
+    fout_flush();                       /// * pass partial line on
+    bool done = VM_ST()!=HOLD;          ///< STOP (or IO, not supported)
+    vm = v1; tk = t1;                   /// * restore caller's context
+
+    if (done) t->_done = true;          /// * t is owned by join from here
+    else      sched().push(t, true);
+}
+///
+///> host thread helps running tasks until t is done
+///
+void task_wait(Task *t) {
+    while (!t->_done) {
+        Task *x = sched().take(-1);
+        if (x) task_run(x);
+        else   yield();
+    }
+}
+Sched::Sched() {
+    n  = E4_NTHREAD ? E4_NTHREAD : (int)thread::hardware_concurrency();
+    if (n < 1) n = 1;
+    qs = new TaskQ[n];
+    for (int i = 0; i < n; i++) th.emplace_back(&Sched::worker, this, i);
+}
+Sched::~Sched() {
+    quit = true;
+    { lock_guard<mutex> lk(mx); }       /// * no lost wake up
+    cv.notify_all();
+    for (auto &x : th) x.join();
+    delete[] qs;
+}
+void Sched::push(Task *t, bool front) {
+    TaskQ &w = qs[wid >= 0 ? wid : (int)(rr++ % n)];
+    {
+        lock_guard<mutex> lk(w.mx);
+        if (front) w.q.push_front(t);
+        else       w.q.push_back(t);
+    }
+    nrdy++;
+    { lock_guard<mutex> lk(mx); }       /// * no lost wake up
+    cv.notify_one();
+}
+Task *Sched::take(int i) {
+    int own = i >= 0;
+    if (i < 0) i = 0;
+    for (int k = 0; k < n; k++) {
+        TaskQ &w = qs[(i + k) % n];
+        lock_guard<mutex> lk(w.mx);
+        if (w.q.empty()) continue;
+        Task *t;
+        if (own && k==0) { t = w.q.back();  w.q.pop_back();  }  /// * own, newest
+        else             { t = w.q.front(); w.q.pop_front(); }  /// * steal, oldest
+        nrdy--;
+        return t;
+    }
+    return 0;
+}
+void Sched::worker(int i) {
+    wid = i;
+    while (!quit) {
+        Task *t = take(i);
+        if (t) { task_run(t); continue; }
+        unique_lock<mutex> lk(mx);
+        cv.wait(lk, [this]{ return nrdy > 0 || quit; });
+    }
+}
+///
+///> Forth words
+///
+IU task_spawn(IU w, DU n) {             ///> ( n xt -- t ) run word w with n on its stack
+    Task *t = new Task(vm->_ss.sz, vm->_rs.sz);
+    t->_vm  = vm;
+    t->_xt  = w;
+    t->_ss.push(t->_tos);               /// * same as PUSH(n)
+    t->_tos = n;
+
+    lock_guard<mutex> lk(vm->_tmx);
+    for (int i = 0; i < E4_TASK_SZ; i++) {
+        if (vm->_task[i]) continue;
+        vm->_task[i] = t;
+        sched().push(t);
+        return i + 1;                   /// * task id
+    }
+    delete t;
+    return 0;                           /// * task table full
+}
+void task_join() {                      ///> ( t -- n ) n is the task's top of stack
+    IU   id = UINT(VM_TOS());
+    Task *t = 0;
+    if (id && id <= E4_TASK_SZ) {
+        lock_guard<mutex> lk(vm->_tmx);
+        t = vm->_task[id - 1];
+    }
+    if (!t) { pstr("task?", CR); VM_TOS() = DU0; return; }
+    if (!t->_done) {
+        if (tk != vm) {                 /// * in a task, retry join after yield
+            VM_IP() -= sizeof(IU); VM_ST() = HOLD; tk->_yld = true;
+            return;
+        }
+        task_wait(t);                   /// * host runs tasks meanwhile
+    }
+    VM_TOS() = t->_tos;
+    {
+        lock_guard<mutex> lk(vm->_tmx);
+        vm->_task[id - 1] = 0;
+    }
+    delete t;
+}
+void task_free(ForthVM *v) {            ///< wait for tasks of v to finish
+    for (auto &t : v->_task) {
+        if (!t) continue;
+        task_wait(t);
+        delete t;
+        t = 0;
+    }
+}
+#else  // !DO_MULTITASK
+void task_free(ForthVM *v) {}
+#endif // DO_MULTITASK
+///@}
+///====================================================================
+///
+///@name Bulk vector ops - DU arrays in pmem, one call per array
+///@brief
+///    * 4-lane GCC/Clang vector extension, lowered to SSE or NEON natively
+///    * and to SIMD128 under Emscripten (-msimd128), scalar tail/fallback
+///    * arrays can sit at any 2-byte offset, so lanes move by memcpy
+///@{
+#define VDU(a)    ((DU*)MEM(a))            /**< DU array at pmem offset a               */
+#if DO_SIMD
+typedef DU V4 __attribute__((vector_size(4 * sizeof(DU))));
+inline V4   v4_ld(const DU *p)  { V4 v; memcpy(&v, p, sizeof(V4)); return v; }
+inline void v4_st(DU *p, V4 v)  { memcpy(p, &v, sizeof(V4)); }
+#endif // DO_SIMD
+template<class F>
+void vec_zip(DU *a, DU *b, DU *c, int n, F f) {   ///< c[i] = f(a[i], b[i])
+    int i = 0;
+#if DO_SIMD
+    for (; i + 4 <= n; i += 4) v4_st(c + i, f(v4_ld(a + i), v4_ld(b + i)));
+#endif // DO_SIMD
+    for (; i < n; i++) c[i] = f(a[i], b[i]);
+}
+DU vec_dot(DU *a, DU *b, int n) {          ///< b=NULL for sum of a
+    DU  s = DU0;
+    int i = 0;
+#if DO_SIMD
+    V4 v = {};
+    for (; i + 4 <= n; i += 4) v += b ? v4_ld(a + i) * v4_ld(b + i) : v4_ld(a + i);
+    s = (v[0] + v[1]) + (v[2] + v[3]);
+#endif // DO_SIMD
+    for (; i < n; i++) s += b ? a[i] * b[i] : a[i];
+    return s;
+}
+DU vec_min(DU *a, int n, bool mx) {        ///< min (or max) of a, 0 if empty
+    if (n <= 0) return DU0;
+    DU  m = a[0];
+    int i = 0;
+    auto pick = [mx](auto x, auto y) { return (mx ? x > y : x < y) ? x : y; };
+#if DO_SIMD
+    if (n >= 4) {
+        V4 v = v4_ld(a);
+        for (i = 4; i + 4 <= n; i += 4) {
+            V4 x = v4_ld(a + i);
+            v = mx ? (x > v ? x : v) : (x < v ? x : v);
+        }
+        m = pick(pick(v[0], v[1]), pick(v[2], v[3]));
+    }
+#endif // DO_SIMD
+    for (; i < n; i++) m = pick(a[i], m);
+    return m;
 }
+///@}
 ///====================================================================
 ///
 ///> eForth dictionary assembler
 ///  Note: sequenced by enum forth_opcode as following
 ///
-UFP Code::XT0 = ~0;    ///< init base of xt pointers (before calling CODE macros)
+FPTR Code::XTAB[E4_DICT_SZ];  ///< built-in xt, filled by the CODE macros
+IU   Code::XTN = 0;           ///< next built-in token
 
 void dict_compile() {  ///< compile built-in words into dictionary
     CODE("nul ",    {});                  /// dict[0], not used, simplify find()
@@ -319,76 +1663,76 @@ void dict_compile() {  ///< compile built-in words into dictionary
     /// @defgroup Stack ops
     /// @brief - opcode sequence can be changed below this line
     /// @{
-    CODE("dup",     PUSH(tos));
-    CODE("drop",    tos = ss.pop());
-    CODE("over",    PUSH(ss[-1]));
-    CODE("swap",    DU n = ss.pop(); PUSH(n));
-    CODE("rot",     DU n = ss.pop(); DU m = ss.pop(); ss.push(n); PUSH(m));
-    CODE("-rot",    DU n = ss.pop(); DU m = ss.pop(); PUSH(m); PUSH(n));
-    CODE("nip",     ss.pop());
-    CODE("pick",    DU i = tos; tos = ss[-i]);
+    CODE("dup",     PUSH(VM_TOS()));
+    CODE("drop",    VM_TOS() = VM_SS().pop());
+    CODE("over",    PUSH(VM_SS()[-1]));
+    CODE("swap",    DU n = VM_SS().pop(); PUSH(n));
+    CODE("rot",     DU n = VM_SS().pop(); DU m = VM_SS().pop(); VM_SS().push(n); PUSH(m));
+    CODE("-rot",    DU n = VM_SS().pop(); DU m = VM_SS().pop(); PUSH(m); PUSH(n));
+    CODE("nip",     VM_SS().pop());
+    CODE("pick",    DU i = VM_TOS(); VM_TOS() = VM_SS()[-i]);
     /// @}
     /// @defgroup Stack ops - double
     /// @{
-    CODE("2dup",    PUSH(ss[-1]); PUSH(ss[-1]));
-    CODE("2drop",   ss.pop(); tos = ss.pop());
-    CODE("2over",   PUSH(ss[-3]); PUSH(ss[-3]));
-    CODE("2swap",   DU n = ss.pop(); DU m = ss.pop(); DU l = ss.pop();
-                    ss.push(n); PUSH(l); PUSH(m));
-    CODE("?dup",    if (tos != DU0) PUSH(tos));
+    CODE("2dup",    PUSH(VM_SS()[-1]); PUSH(VM_SS()[-1]));
+    CODE("2drop",   VM_SS().pop(); VM_TOS() = VM_SS().pop());
+    CODE("2over",   PUSH(VM_SS()[-3]); PUSH(VM_SS()[-3]));
+    CODE("2swap",   DU n = VM_SS().pop(); DU m = VM_SS().pop(); DU l = VM_SS().pop();
+                    VM_SS().push(n); PUSH(l); PUSH(m));
+    CODE("?dup",    if (VM_TOS() != DU0) PUSH(VM_TOS()));
     /// @}
     /// @defgroup ALU ops
     /// @{
-    CODE("+",       tos += ss.pop());
-    CODE("*",       tos *= ss.pop());
-    CODE("-",       tos =  ss.pop() - tos);
-    CODE("/",       tos =  ss.pop() / tos);
-    CODE("mod",     tos =  MOD(ss.pop(), tos));
-    CODE("*/",      tos =  (DU2)ss.pop() * ss.pop() / tos);
-    CODE("/mod",    DU  n = ss.pop();
-                    DU  t = tos;
+    CODE("+",       VM_TOS() += VM_SS().pop());
+    CODE("*",       VM_TOS() *= VM_SS().pop());
+    CODE("-",       VM_TOS() =  VM_SS().pop() - VM_TOS());
+    CODE("/",       VM_TOS() =  VM_SS().pop() / VM_TOS());
+    CODE("mod",     VM_TOS() =  MOD(VM_SS().pop(), VM_TOS()));
+    CODE("*/",      VM_TOS() =  (DU2)VM_SS().pop() * VM_SS().pop() / VM_TOS());
+    CODE("/mod",    DU  n = VM_SS().pop();
+                    DU  t = VM_TOS();
                     DU  m = MOD(n, t);
-                    ss.push(m); tos = UINT(n / t));
-    CODE("*/mod",   DU2 n = (DU2)ss.pop() * ss.pop();
-                    DU2 t = tos;
+                    VM_SS().push(m); VM_TOS() = UINT(n / t));
+    CODE("*/mod",   DU2 n = (DU2)VM_SS().pop() * VM_SS().pop();
+                    DU2 t = VM_TOS();
                     DU  m = MOD(n, t);
-                    ss.push(m); tos = UINT(n / t));
-    CODE("and",     tos = UINT(tos) & UINT(ss.pop()));
-    CODE("or",      tos = UINT(tos) | UINT(ss.pop()));
-    CODE("xor",     tos = UINT(tos) ^ UINT(ss.pop()));
-    CODE("abs",     tos = ABS(tos));
-    CODE("negate",  tos = -tos);
-    CODE("invert",  tos = ~UINT(tos));
-    CODE("rshift",  tos = UINT(ss.pop()) >> UINT(tos));
-    CODE("lshift",  tos = UINT(ss.pop()) << UINT(tos));
-    CODE("max",     DU n=ss.pop(); tos = (tos>n) ? tos : n);
-    CODE("min",     DU n=ss.pop(); tos = (tos<n) ? tos : n);
-    CODE("2*",      tos *= 2);
-    CODE("2/",      tos /= 2);
-    CODE("1+",      tos += 1);
-    CODE("1-",      tos -= 1);
+                    VM_SS().push(m); VM_TOS() = UINT(n / t));
+    CODE("and",     VM_TOS() = UINT(VM_TOS()) & UINT(VM_SS().pop()));
+    CODE("or",      VM_TOS() = UINT(VM_TOS()) | UINT(VM_SS().pop()));
+    CODE("xor",     VM_TOS() = UINT(VM_TOS()) ^ UINT(VM_SS().pop()));
+    CODE("abs",     VM_TOS() = ABS(VM_TOS()));
+    CODE("negate",  VM_TOS() = -VM_TOS());
+    CODE("invert",  VM_TOS() = ~UINT(VM_TOS()));
+    CODE("rshift",  VM_TOS() = UINT(VM_SS().pop()) >> UINT(VM_TOS()));
+    CODE("lshift",  VM_TOS() = UINT(VM_SS().pop()) << UINT(VM_TOS()));
+    CODE("max",     DU n=VM_SS().pop(); VM_TOS() = (VM_TOS()>n) ? VM_TOS() : n);
+    CODE("min",     DU n=VM_SS().pop(); VM_TOS() = (VM_TOS()<n) ? VM_TOS() : n);
+    CODE("2*",      VM_TOS() *= 2);
+    CODE("2/",      VM_TOS() /= 2);
+    CODE("1+",      VM_TOS() += 1);
+    CODE("1-",      VM_TOS() -= 1);
 #if USE_FLOAT
-    CODE("int",     tos = UINT(tos));         // float => integer
+    CODE("int",     VM_TOS() = UINT(VM_TOS())); // float => integer
 #endif // USE_FLOAT
     /// @}
     /// @defgroup Logic ops
     /// @{
-    CODE("0=",      tos = BOOL(ZEQ(tos)));
-    CODE("0<",      tos = BOOL(LT(tos, DU0)));
-    CODE("0>",      tos = BOOL(GT(tos, DU0)));
-    CODE("=",       tos = BOOL(EQ(ss.pop(), tos)));
-    CODE(">",       tos = BOOL(GT(ss.pop(), tos)));
-    CODE("<",       tos = BOOL(LT(ss.pop(), tos)));
-    CODE("<>",      tos = BOOL(!EQ(ss.pop(), tos)));
-    CODE(">=",      tos = BOOL(!LT(ss.pop(), tos)));
-    CODE("<=",      tos = BOOL(!GT(ss.pop(), tos)));
-    CODE("u<",      tos = BOOL(UINT(ss.pop()) < UINT(tos)));
-    CODE("u>",      tos = BOOL(UINT(ss.pop()) > UINT(tos)));
+    CODE("0=",      VM_TOS() = BOOL(ZEQ(VM_TOS())));
+    CODE("0<",      VM_TOS() = BOOL(LT(VM_TOS(), DU0)));
+    CODE("0>",      VM_TOS() = BOOL(GT(VM_TOS(), DU0)));
+    CODE("=",       VM_TOS() = BOOL(EQ(VM_SS().pop(), VM_TOS())));
+    CODE(">",       VM_TOS() = BOOL(GT(VM_SS().pop(), VM_TOS())));
+    CODE("<",       VM_TOS() = BOOL(LT(VM_SS().pop(), VM_TOS())));
+    CODE("<>",      VM_TOS() = BOOL(!EQ(VM_SS().pop(), VM_TOS())));
+    CODE(">=",      VM_TOS() = BOOL(!LT(VM_SS().pop(), VM_TOS())));
+    CODE("<=",      VM_TOS() = BOOL(!GT(VM_SS().pop(), VM_TOS())));
+    CODE("u<",      VM_TOS() = BOOL(UINT(VM_SS().pop()) < UINT(VM_TOS())));
+    CODE("u>",      VM_TOS() = BOOL(UINT(VM_SS().pop()) > UINT(VM_TOS())));
     /// @}
     /// @defgroup IO ops
     /// @{
-    CODE("case!",   upper = POP() == DU0);    // case insensitive
-    CODE("base",    PUSH(((U8*)base - MEM0)));
+    CODE("case!",   VM_UPPER() = POP() == DU0); // case insensitive
+    CODE("base",    PUSH(((U8*)VM_BASE() - MEM0)));
     CODE("decimal", put(BASE, 10));
     CODE("hex",     put(BASE, 16));
     CODE("bl",      put(BL));
@@ -398,17 +1742,17 @@ void dict_compile() {  ///< compile built-in words into dictionary
     CODE(".r",      IU w = UINT(POP()); put(DOTR, w, POP()));
     CODE("u.r",     IU w = UINT(POP()); put(DOTR, w, UINT(POP())));
     CODE("type",    POP(); pstr((const char*)MEM(POP())));    // get string pointer
-    IMMD("key",     if (compile) add_w(KEY); else key());
+    IMMD("key",     if (VM_COMP()) add_w(KEY); else key());
     CODE("emit",    put(EMIT, POP()));
     CODE("space",   spaces(1));
     CODE("spaces",  spaces(POP()));
     /// @}
     /// @defgroup Literal ops
     /// @{
-    CODE("[",       compile = false);
-    CODE("]",       compile = true);
+    CODE("[",       VM_COMP() = false);
+    CODE("]",       VM_COMP() = true);
     IMMD("(",       scan(')'));
-    IMMD(".(",      pstr(scan(')')));
+    IMMD(".(",      Str t = scan(')'); VM_FOUT().write(t.s, t.n));
     IMMD("\\",      scan('\n'));
     IMMD("s\"",     s_quote(STR));
     IMMD(".\"",     s_quote(DOTQ));
@@ -445,27 +1789,28 @@ void dict_compile() {  ///< compile built-in words into dictionary
     /// @defgrouop DO..LOOP loops
     /// @{
     IMMD("do" ,     add_w(DO); PUSH(HERE));                     // for ( -- here )
-    CODE("i",       PUSH(rs[-1]));
-    CODE("leave",   rs.pop(); rs.pop(); UNNEST());              // quit DO..LOOP
+    CODE("i",       PUSH(VM_RS()[-1]));
+    CODE("leave",   VM_RS().pop(); VM_RS().pop(); UNNEST());    // quit DO..LOOP
     IMMD("loop",    add_w(LOOP); add_iu(POP()));                // next ( here -- )
     /// @}
     /// @defgrouop return stack ops
     /// @{
-    CODE(">r",      rs.push(POP()));
-    CODE("r>",      PUSH(rs.pop()));
-    CODE("r@",      PUSH(rs[-1]));                              // same as I (the loop counter)
+    CODE(">r",      VM_RS().push(POP()));
+    CODE("r>",      PUSH(VM_RS().pop()));
+    CODE("r@",      PUSH(VM_RS()[-1]));                         // same as I (the loop counter)
     /// @}
     /// @defgrouop Compiler ops
     /// @{
-    CODE(":",       compile = def_word(word()));
-    IMMD(";",       add_w(EXIT); compile = false);
+    CODE(":",       VM_COMP() = def_word(word()));
+    IMMD(";",       add_w(EXIT); VM_COMP() = false; fuse(LAST.pfa); SFX_WORD(VM_DICT().idx - 1));
     CODE("exit",    UNNEST());                                  // early exit the colon word
-    CODE("variable",def_word(word()); add_var(VAR));            // create a variable
+    CODE("variable",def_word(word()); add_var(VAR);             // create a variable
+         SFX_WORD(VM_DICT().idx - 1));
     CODE("constant",                                            // create a constant
          def_word(word());                                      // create a new word on dictionary
          add_w(LIT); add_du(POP());                             // dovar (+parameter field)
-         add_w(EXIT));
-    IMMD("immediate", dict[-1].attr |= IMM_ATTR);
+         add_w(EXIT); SFX_WORD(VM_DICT().idx - 1));
+    IMMD("immediate", VM_DICT()[-1].attr |= IMM_ATTR; DICT_SYNC(VM_DICT().idx - 1));
     /// @}
     /// @defgroup metacompiler
     /// @brief - dict is directly used, instead of shield by macros
@@ -474,70 +1819,124 @@ void dict_compile() {  ///< compile built-in words into dictionary
     CODE("create", def_word(word()); add_var(VBRAN));           // bran + offset field
     IMMD("does>",  add_w(DOES));
     IMMD("to",                                                  // alter the value of a constant, i.e. 3 to x
-         IU w = VM==QUERY ? find(word()) : POP();               // constant addr
+         IU w = VM_ST()==QUERY ? find(word()) : POP();          // constant addr
          if (!w) return;
-         if (compile) {
+         if (VM_COMP()) {
              add_w(LIT); add_du((DU)w);                         // save addr on stack
              add_w(find("to"));                                 // encode to opcode
          }
          else {
-             *(DU*)(MEM(dict[w].pfa) + sizeof(IU)) = POP();     // update constant
+             IU a = DALIGN(VM_DICT()[w].pfa + sizeof(IU));
+             CELL(a) = POP(); DIRTY(a, sizeof(DU));         // update constant
+             JIT_FLUSH();                                       // JIT code holds the old value
          });
     IMMD("is",              // ' y is x                         // alias a word, i.e. ' y is x
-         IU w = VM==QUERY ? find(word()) : POP();               // word addr
+         IU w = VM_ST()==QUERY ? find(word()) : POP();          // word addr
          if (!w) return;
-         if (compile) {
+         if (VM_COMP()) {
              add_w(LIT); add_du((DU)w);                         // save addr on stack
              add_w(find("is"));
          }
          else {
-             dict[POP()].xt = dict[w].xt;
+             IU x = POP(); Code &e = VM_DICT()[x];
+             e.attr = VM_DICT()[w].attr; e.pfa = VM_DICT()[w].pfa;  // name kept
+             dict_reref(x); DICT_SYNC(x); DICT_CUT(x);
+             JIT_FLUSH();
          });
     ///
     /// be careful with memory access, especially BYTE because
     /// it could make access misaligned which slows the access speed by 2x
+    /// (USE_CALIGN keeps every compiled cell on a 4-byte boundary, but
+    /// user addresses can be anything, so these go through CGET/CSET)
     ///
     CODE("@",                                                   // w -- n
          IU w = UINT(POP());
-         PUSH(w < USER_AREA ? (DU)IGET(w) : CELL(w)));          // check user area
-    CODE("!",     IU w = UINT(POP()); CELL(w) = POP(););        // n w --
+         PUSH(w < USER_AREA ? (DU)IGET(w) : CGET(w)));          // check user area
+    CODE("!",     IU w = UINT(POP()); CSET(w, POP()); DIRTY(w, sizeof(DU))); // n w --
     CODE(",",     DU n = POP(); add_du(n));                     // n -- , compile a cell
-    CODE("n,",    IU i = UINT(POP()); add_iu(i));               // compile a 16-bit value
+    CODE("n,",    IU i = UINT(POP()); add_iu(i));               // compile an IU (16 or 32-bit)
     CODE("cells", IU i = UINT(POP()); PUSH(i * sizeof(DU)));    // n -- n'
     CODE("allot",                                               // n --
          IU n = UINT(POP());                                    // number of bytes
-         for (int i = 0; i < n; i+=sizeof(DU)) add_du(DU0));    // zero padding
-    CODE("th",    IU n = POP(); tos += n * sizeof(DU));         // w i -- w'
-    CODE("+!",    IU w = UINT(POP()); CELL(w) += POP());        // n w --
-    CODE("?",     IU w = UINT(POP()); put(DOT, CELL(w)));       // w --
+         for (IU i = 0; i < n; i+=sizeof(DU)) add_du(DU0));    // zero padding
+    CODE("th",    IU n = POP(); VM_TOS() += n * sizeof(DU));    // w i -- w'
+    CODE("+!",    IU w = UINT(POP()); CSET(w, CGET(w) + POP()); DIRTY(w, sizeof(DU))); // n w --
+    CODE("?",     IU w = UINT(POP()); put(DOT, CGET(w)));       // w --
+    CODE("cmove",                                               // a1 a2 u -- , low to high
+         IU n = UINT(POP()); U8 *d = MEM(POP()); U8 *s = MEM(POP());
+         for (IU i = 0; i < n; i++) d[i] = s[i];
+         DIRTY(d - MEM0, n));
+    CODE("move",                                                // a1 a2 u -- , overlap safe
+         IU n = UINT(POP()); U8 *d = MEM(POP()); memmove(d, MEM(POP()), n);
+         DIRTY(d - MEM0, n));
+    CODE("fill",                                                // a u c --
+         U8 c = (U8)UINT(POP()); IU n = UINT(POP()); U8 *d = MEM(POP());
+         memset(d, c, n); DIRTY(d - MEM0, n));
+    ///
+    /// vector ops on arrays of n cells, i.e. made by create ... allot
+    ///
+    CODE("v+",                                                  // a1 a2 a3 n -- , a3 = a1 + a2
+         int n = UINT(POP()); DU *c = VDU(POP()); DU *b = VDU(POP());
+         vec_zip(VDU(POP()), b, c, n, [](auto x, auto y) { return x + y; });
+         DIRTY((U8*)c - MEM0, n * sizeof(DU)));
+    CODE("v*",                                                  // a1 a2 a3 n -- , a3 = a1 * a2
+         int n = UINT(POP()); DU *c = VDU(POP()); DU *b = VDU(POP());
+         vec_zip(VDU(POP()), b, c, n, [](auto x, auto y) { return x * y; });
+         DIRTY((U8*)c - MEM0, n * sizeof(DU)));
+    CODE("vscale",                                              // a1 x a2 n -- , a2 = x * a1
+         int n = UINT(POP()); DU *c = VDU(POP()); DU x = POP(); DU *a = VDU(POP());
+         vec_zip(a, a, c, n, [x](auto v, auto) { return v * x; });
+         DIRTY((U8*)c - MEM0, n * sizeof(DU)));
+    CODE("vdot",  int n = UINT(POP()); DU *b = VDU(POP()); VM_TOS() = vec_dot(VDU(VM_TOS()), b, n)); // a1 a2 n -- x
+    CODE("vsum",  int n = UINT(POP()); VM_TOS() = vec_dot(VDU(VM_TOS()), NULL, n)); // a n -- x
+    CODE("vmin",  int n = UINT(POP()); VM_TOS() = vec_min(VDU(VM_TOS()), n, false)); // a n -- x
+    CODE("vmax",  int n = UINT(POP()); VM_TOS() = vec_min(VDU(VM_TOS()), n, true)); // a n -- x
     /// @}
     /// @defgroup Debug ops
     /// @{
-    CODE("abort", tos = -DU1; ss.clear(); rs.clear());          // clear ss, rs
+    CODE("abort",                                               // clear ss, rs
+         trace_dump(E4_TRACE_DUMP, true);                       // DO_TRACE, how we got here
+         VM_TOS() = -DU1; VM_SS().clear(); VM_RS().clear());
+    CODE("stacks",                                              // ss rs -- , resize, top level only
+         int r = (int)UINT(POP()); int s = (int)UINT(POP());
+         if (tk!=vm || VM_RS().idx || s < 2 * E4_SFX_MARGIN || r < 2 * E4_SFX_MARGIN) {
+             pstr("stacks?", CR); return;
+         }
+         VM_SS().resize(s); VM_RS().resize(r); VM_TOS() = -DU1); // contents dropped, as abort
     CODE("here",  PUSH(HERE));
     CODE("'",     IU w = find(word()); if (w) PUSH(w));
     CODE(".s",    ss_dump(true));
-    CODE("depth", PUSH(ss.idx));
-    CODE("r",     PUSH(rs.idx));
+    CODE("depth", PUSH(VM_SS().idx));
+    CODE("r",     PUSH(VM_RS().idx));
     CODE("words", words());
     CODE("see",
          IU w = find(word()); if (!w) return;
-         pstr(": "); pstr(dict[w].name);
-         if (IS_UDF(w)) see(dict[w].pfa);
+         pstr(": "); pstr(VM_DICT()[w].name);
+         if (IS_UDF(w)) see(VM_DICT()[w].pfa);
          else           pstr(" ( built-ins ) ;");
          put(CR));
     CODE("dump",  U32 n = UINT(POP()); mem_dump(UINT(POP()), n));
     CODE("dict",  dict_dump());
+#if DO_PROFILE
+    CODE("profile-on",  prof_start());
+    CODE("profile-off", prof_on = false);
+    CODE(".profile",    prof_dump());
+#endif // DO_PROFILE
+#if DO_TRACE
+    CODE(".trace",      trace_dump((int)UINT(POP())));      // n -- , last n steps
+#endif // DO_TRACE
     CODE("forget",
          IU w = find(word()); if (!w) return;                  // bail, if not found
          IU b = find("boot")+1;
          if (w > b) {                                          // clear to specified word
-             pmem.clear(dict[w].pfa - STRLEN(dict[w].name));
-             dict.clear(w);
+             VM_PMEM().clear(VM_DICT()[w].pfa - STRLEN(VM_DICT()[w].name));
+             dict_clear(w);
+             DIRTY_LO();
          }
          else {                                                // clear to 'boot'
-             pmem.clear(USER_AREA);
-             dict.clear(b);
+             VM_PMEM().clear(USER_AREA);
+             dict_clear(b);
+             DIRTY_LO();
          }
     );
     /// @}
@@ -546,63 +1945,176 @@ void dict_compile() {  ///< compile built-in words into dictionary
     CODE("mstat", mem_stat());
     CODE("ms",    PUSH(millis()));
     CODE("rnd",   PUSH(RND()));             // generate random number
-    CODE("delay", delay(UINT(POP())));
+    CODE("delay",
+         fout_flush(); U32 ms = UINT(POP());
+         if (!VM_WAIT(WAIT_MS, ms, 0)) delay(ms));
+#if DO_MULTITASK
+    CODE("spawn",                           // ( n xt -- t ) start a task
+         IU w = POP(); VM_TOS() = task_spawn(w, VM_TOS());
+         if (!VM_TOS()) pstr("task full", CR));
+    CODE("yield", VM_ST() = HOLD; tk->_yld = true); // give up time slice
+    CODE("join",  task_join());             // ( t -- n ) wait for task
+#endif // DO_MULTITASK
     CODE("included",                        // include external file
          POP();                             // string length, not used
-         load((const char*)MEM(POP())));    // include external file
+         const char *fn = (const char*)MEM(POP());
+         if (!VM_WAIT(WAIT_LOAD, 0, fn)) load(fn));  // fetched async, or now
 #if DO_WASM
-    CODE("JS",    native_api());            // Javascript interface
+    CODE("JS",    native_api(); VM_WAIT(WAIT_JS, 0, 0));  // Javascript interface
+    CODE("JSB",                             // ( ... a u -- ) binary Javascript call
+         native_bin(); if (!vm->_jsr_b) VM_WAIT(WAIT_JS, 0, 0));
+    CODE("frames",                          // ( a n -- ) 2 buffers of n slots at a
+         vm->_frm_sz = UINT(POP()); vm->_frm = UINT(POP());
+         vm->_frm_b  = vm->_frm_n = 0);
+    CODE("frame",                           // ( -- a ) back buffer, Forth fills it
+         U8 *f = frame_buf(true); PUSH(f ? (IU)(f - MEM0) : 0));
+    CODE("frame-swap",                      // ( n -- ) publish n slots, swap buffers
+         IU n = UINT(POP()); U8 *f = frame_buf(true);
+         if (!f || n > vm->_frm_sz) { pstr("frame?", CR); return; }
+         vm->_frm_b ^= 1; vm->_frm_n = n; vm->_frm_seq++;
+         U8 *b = frame_buf(true); IU sz = n * E4_FRM_SLOT * sizeof(DU);
+         memcpy(b, f, sz); DIRTY(b - MEM0, sz));            // back keeps last frame
+    CODE("JS[",   js_flush(false); vm->_jsr_b = true);   // collect JSB calls
+    CODE("]JS",                             // send collected calls as one message
+         vm->_jsr_b = false; js_flush(true); VM_WAIT(WAIT_JS, 0, 0));
 #else  // !DO_WASM
+    CODE("save-image",                      // ( a u -- ) snapshot to file
+         POP(); forth_image_file((const char*)MEM(POP()), true));
+    CODE("load-image",                      // ( a u -- ) top level only, like boot
+         POP(); IU a = POP();
+         if (tk!=vm || VM_RS().idx) { pstr("load-image?", CR); return; }
+         forth_image_file((const char*)MEM(a), false));
     CODE("bye",   exit(0));
 #endif // DO_WASM    
     /// @}
-    CODE("boot",  dict.clear(find("boot") + 1); pmem.clear(sizeof(DU)));
+    CODE("boot",  dict_clear(find("boot") + 1); VM_PMEM().clear(USER_AREA); DIRTY_LO());
 }
 ///====================================================================
 ///
 ///> ForthVM - Outer interpreter
 ///
-DU parse_number(const char *idiom, int *err) {
-    int b = static_cast<int>(*base);
-    switch (*idiom) {                        ///> base override
-    case '%': b = 2;  idiom++; break;
-    case '&':
-    case '#': b = 10; idiom++; break;
-    case '$': b = 16; idiom++; break;
-    }
+///
+///> strto* fallback, for what the fast path leaves (inf, nan, 0x.., long mantissa)
+///
+DU parse_slow(const char *s, int len, int b, int *err) {
+    char buf[E4_TOK_SZ];                     ///< '\0' terminated for strtol
+    memcpy(buf, s, len); buf[len] = '\0';
     char *p;
-    *err = errno = 0;
+    errno = 0;
 #if USE_FLOAT
     DU n = (b==10)
-        ? static_cast<DU>(strtof(idiom, &p))
-        : static_cast<DU>(strtol(idiom, &p, b));
+        ? static_cast<DU>(strtof(buf, &p))
+        : static_cast<DU>(strtol(buf, &p, b));
 #else  // !USE_FLOAT
-    DU n = static_cast<DU>(strtol(idiom, &p, b));
+    DU n = static_cast<DU>(strtol(buf, &p, b));
 #endif // USE_FLOAT
-    if (errno || *p != '\0') *err = 1;
+    *err = errno || *p != '\0';
     return n;
 }
+///
+///> one pass parser, [%#&$][-+]digits in *base (or prefix base)
+///> USE_FLOAT: base 10 takes [.digits][e[-+]digits] too, m * 10^e exact in float
+///  (m < 2^24, |e| <= 10) rounds once, as strtof does, no locale, no errno
+///
+DU parse_number(const char *s, int len, int *err) {
+    *err = len >= E4_TOK_SZ;
+    if (*err) return DU0;
 
-void forth_core(const char *idiom) {     ///> aka QUERY
-    VM = QUERY;
-    IU w = find(idiom);                  ///> * get token by searching through dict
-    if (w) {                             ///> * word found?
-        if (compile && !IS_IMM(w)) {     /// * in compile mode?
-            add_w(w);                    /// * add to colon word
+    const char *p = s, *e = s + len;
+    int b = static_cast<int>(*VM_BASE());
+    switch (*p) {                            ///> base override
+    case '%': b = 2;  p++; break;
+    case '&':
+    case '#': b = 10; p++; break;
+    case '$': b = 16; p++; break;
+    }
+    bool neg = p < e && *p == '-';
+    const char *d0 = p + (p < e && (*p == '-' || *p == '+'));  ///< first digit
+    if (b < 2 || b > 36 ||                   /// * as strtol would take them
+        (d0 < e && (*d0 == '0') && d0 + 1 < e && (d0[1] | 0x20) == 'x') ||
+        (USE_FLOAT && b == 10 && d0 < e && ((*d0 | 0x20) == 'i' || (*d0 | 0x20) == 'n'))) {
+        return parse_slow(p, (int)(e - p), b, err);
+    }
+    auto digit = [](char c) {                ///< 0..35, 99: not a digit
+        return (c >= '0' && c <= '9') ? c - '0'
+            : ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') ? (c | 0x20) - 'a' + 10 : 99;
+    };
+    U64 n  = 0;                              ///< magnitude so far
+    int nd = 0;                              ///< significant digits taken
+    const char *q = d0;
+#if USE_FLOAT
+    if (b == 10) {
+        int x = 0;                           ///< decimal exponent
+        for (; q < e && *q >= '0' && *q <= '9'; q++, nd++) {
+            if (n < 100000000ULL) n = n * 10 + (*q - '0');
+            else x++;                        /// * past float precision
+        }
+        if (q < e && *q == '.') {
+            for (q++; q < e && *q >= '0' && *q <= '9'; q++, nd++) {
+                if (n < 100000000ULL) { n = n * 10 + (*q - '0'); x--; }
+            }
+        }
+        if (nd && q < e && (*q | 0x20) == 'e') {
+            const char *r = q + 1;
+            bool xn = r < e && *r == '-';
+            if (r < e && (*r == '-' || *r == '+')) r++;
+            int v = 0;
+            const char *r0 = r;
+            for (; r < e && *r >= '0' && *r <= '9'; r++) if (v < 1000) v = v * 10 + (*r - '0');
+            if (r > r0) { x += xn ? -v : v; q = r; }
+        }
+        *err = (!nd && p < e) || q != e;     /// * a lone prefix is 0, as strtof gives
+        static const float P10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+        if (n >= (1ULL << 24) || x > 10 || x < -10) {
+            return *err ? DU0 : parse_slow(p, (int)(e - p), b, err);
+        }
+        float f = x < 0 ? (float)n / P10[-x] : (float)n * P10[x];
+        return neg ? -f : f;
+    }
+#endif // USE_FLOAT
+    const U64 lim = (U64)LONG_MAX + neg;     ///< strtol range
+    for (; q < e; q++, nd++) {
+        int v = digit(*q);
+        if (v >= b) break;
+        if (n > (lim - v) / b) return parse_slow(p, (int)(e - p), b, err);  /// * ERANGE
+        n = n * b + v;
+    }
+    *err = (!nd && p < e) || q != e;         /// * a lone prefix is 0, as strtol gives
+    return static_cast<DU>((long)(neg ? 0 - n : n));  /// * LONG_MIN wraps back
+}
+///
+///> 12, -3, $1f, #7 look like numbers, parse them before the dict search
+///  1+, 2dup fail the parse and are still found
+///
+#define NUM_1ST(s, n) \
+    ((*(s) >= '0' && *(s) <= '9') || \
+     ((n) > 1 && strchr("-+%#$&", *(s)) && (s)[1] >= '0' && (s)[1] <= '9'))
+
+void forth_core(const char *idiom, int len) {  ///> aka QUERY
+    VM_ST() = QUERY;
+    int  err = 1;
+    bool num = NUM_1ST(idiom, len);
+    DU   n   = num ? parse_number(idiom, len, &err) : DU0;
+    if (err) {
+        IU w = find(idiom, len);         ///> * get token by searching through dict
+        if (w) {                         ///> * word found?
+            if (VM_COMP() && !IS_IMM(w)) { /// * in compile mode?
+                if (!inline_w(w)) add_w(w); /// * add to colon word (or expand it)
+            }
+            else CALL(w);                /// * execute forth word
+            return;
         }
-        else CALL(w);                    /// * execute forth word
-        return;
     }
     // try as a number
-    int err = 0;
-    DU  n   = parse_number(idiom, &err);
+    if (err && !num) n = parse_number(idiom, len, &err);
     if (err) {                           /// * not number
-        pstr(idiom); pstr("? ", CR);     ///> display error prompt
-        compile = false;                 ///> reset to interpreter mode
-        VM      = STOP;                  ///> skip the entire input buffer
+        VM_FOUT().write(idiom, len);     ///> display error prompt
+        pstr("? ", CR);
+        VM_COMP() = false;               ///> reset to interpreter mode
+        VM_ST()   = STOP;                ///> skip the entire input buffer
     }
     // is a number
-    if (compile) {                       /// * a number in compile mode?
+    if (VM_COMP()) {                     /// * a number in compile mode?
         add_w(LIT);                      ///> add to current word
         add_du(n);
     }
@@ -612,53 +2124,227 @@ void forth_core(const char *idiom) {     ///> aka QUERY
 ///
 /// Forth VM external command processor
 ///
-void forth_init() {
-    static bool init = false;
-    if (init) return;                    ///> check dictionary initilized
-
-    base = &IGET(HERE);                  ///< set pointer to base
+void user_area() {                       ///< setup user variables of current VM
+    VM_BASE() = &IGET(HERE);             ///< set pointer to base
     add_iu(10);                          ///< allocate space for base
-    dflt = &IGET(HERE);                  ///< set pointer to dfmt
+    VM_DFLT() = &IGET(HERE);             ///< set pointer to dfmt
     add_iu(USE_FLOAT);
     
-    for (int i=pmem.idx; i<USER_AREA; i+=sizeof(IU)) {
-        add_iu(0xffff);                  /// * padding user area
+    for (IU i=HERE; i<USER_AREA; i+=sizeof(IU)) {
+        add_iu((IU)~0);                  /// * padding user area
     }
+}
+ForthVM *forth_init() {
+    if (vm0) return vm0;                 ///> check dictionary initilized
+
+    vm = vm0 = new ForthVM();            ///< first VM owns the built-ins
+    tk = vm;
+    stk_init();                          ///> stack guard fault handler
+    user_area();
     dict_compile();                      ///> compile dictionary
+    fuse_init();                         ///> capture tokens for fusion
+    sfx_init();                          ///> built-in stack effects
+    return vm0;
+}
+ForthVM *forth_new(int ss_sz, int rs_sz) {
+    ForthVM *v0 = forth_init();          ///< built-ins are compiled only once
+    ForthVM *v1 = vm;                    ///< keep caller's context
+    Task    *t1 = tk;
+    tk = vm = new ForthVM(ss_sz, rs_sz);
+#if USE_IU32
+    if (!vm->_pmem.v) {                  /// * no address range left to reserve
+        delete vm;
+        vm = v1; tk = t1;
+        return 0;
+    }
+#endif // USE_IU32
+    user_area();
+    for (int i = 0; i < v0->_dict.idx; i++) {
+        Code &c = v0->_dict[i];          /// * share name and xt of built-ins
+        dict_add(c);
+        if (strcmp(c.name, "boot")==0) break;  /// * up to the fence
+    }
+    ForthVM *v = vm;
+    vm = v1; tk = t1;                    /// * restore caller's context
+    return v;
 }
-int forth_vm(const char *line, void(*hook)(int, const char*)) {
+void forth_free(ForthVM *v) {
+    if (!v || v==vm0) return;            /// * first VM stays
+    task_free(v);                        /// * wait for spawned tasks
+#if DO_JIT
+    jit_free(v);
+#endif // DO_JIT
+    if (vm==v) tk = vm = vm0;
+    delete v;
+}
+///====================================================================
+///
+///@name Image snapshot - colon words and pmem, skip bootstrap replay
+///@brief
+///    * built-ins are recompiled by forth_init, only the part past the
+///    * 'boot' fence is saved (name offset, attr, pfa), with pmem[0, HERE)
+///    * which also carries base and dflt in the user area
+///    * colon words hold XTAB indices of built-ins, so an image is tied
+///    * to the built-in word set, guarded by a built-in fingerprint
+///@{
+#define IMG_MAGIC  0x6d693465              /**< "e4im"                        */
+#define IMG_LAYOUT (sizeof(IU) | sizeof(DU) << 8 | DALIGN(1) << 16)  /**< cell layout */
+struct ImgHdr {
+    U32 magic;                             ///< IMG_MAGIC
+    U32 fprint;                            ///< fingerprint of built-ins
+    U32 iu;                                ///< IMG_LAYOUT, i.e. IU, DU sizes
+    U32 nbuilt;                            ///< dict index past 'boot'
+    U32 ndict;                             ///< dict.idx
+    U32 here;                              ///< pmem.idx
+    U32 ucase;                             ///< case insensitive flag
+};
+struct ImgCode { U32 name; U32 attr; U32 pfa; };
+U32 image_fprint(IU n) {                   ///< FNV-1a of built-in names and tokens
+    U32 h = 2166136261u;
+    for (IU i = 0; i < n; i++) {
+        for (const char *s = VM_DICT()[i].name; *s; s++) h = (h ^ (U8)*s) * 16777619u;
+        h = (h ^ VM_DICT()[i].xti()) * 16777619u;
+    }
+    return h;
+}
+int forth_image_save(U8 *buf, int max) {   ///< 0: too small, buf=NULL: size query
+    IU  nb = find("boot") + 1;
+    int nc = VM_DICT().idx - nb;
+    int sz = (int)(sizeof(ImgHdr) + nc * sizeof(ImgCode)) + HERE;
+    if (!buf)     return sz;
+    if (max < sz) return 0;
+
+    ImgHdr h = {
+        IMG_MAGIC, image_fprint(nb), IMG_LAYOUT,
+        nb, (U32)VM_DICT().idx, (U32)HERE, VM_UPPER()
+    };
+    memcpy(buf, &h, sizeof(h)); buf += sizeof(h);
+    for (int i = nb; i < VM_DICT().idx; i++) {
+        Code   &c = VM_DICT()[i];
+        ImgCode x = { (U32)((U8*)c.name - MEM0), c.attr, c.pfa };
+        memcpy(buf, &x, sizeof(x)); buf += sizeof(x);
+    }
+    memcpy(buf, MEM0, HERE);
+    return sz;
+}
+int forth_image_load(const U8 *buf, int n) {  ///< 1: loaded, 0: rejected
+    ImgHdr h;
+    if (n < (int)sizeof(h)) return 0;
+    memcpy(&h, buf, sizeof(h));
+    int nc = (int)h.ndict - (int)h.nbuilt;
+    if (h.magic != IMG_MAGIC ||
+        h.iu != IMG_LAYOUT ||
+        h.nbuilt != (U32)find("boot") + 1 ||
+        h.fprint != image_fprint(h.nbuilt) ||
+        nc < 0 || h.ndict > E4_DICT_SZ ||
+        h.here < USER_AREA || h.here > E4_PMEM_SZ ||
+        n != (int)(sizeof(h) + nc * sizeof(ImgCode) + h.here)) return 0;
+
+    const U8 *p = buf + sizeof(h);
+    dict_clear(h.nbuilt);                  /// * same as boot
+    VM_PMEM().clear();                     /// * push, so VMem can grow
+    DIRTY_LO();
+    VM_PMEM().push((U8*)p + nc * sizeof(ImgCode), h.here); /// * base, dflt come along
+    for (int i = 0; i < nc; i++, p += sizeof(ImgCode)) {
+        ImgCode x; memcpy(&x, p, sizeof(x));
+        Code c;
+        c.name = (const char*)MEM0 + x.name;
+        c.attr = (IU)x.attr;
+        c.pfa  = (IU)x.pfa;
+        dict_add(c);                       /// * rebuild hash chains
+    }
+    for (IU w = h.nbuilt; w < h.ndict; w++) SFX_WORD(w);  /// * in order, callees first
+    VM_UPPER() = h.ucase;
+    VM_COMP()  = false;
+    return 1;
+}
+///@}
+int vm_eval(const char *line, int len, void(*hook)(int, const char*), ForthVM *h) {
+    ForthVM *v1 = vm;                    ///< keep caller's context
+    Task    *t1 = tk;
+    if (h) vm = h;                       /// * switch to given VM
+    tk = vm;                             /// * as its main task
+    
     auto time_up = []() {                /// * time slice up
         static long t0 = 0;              /// * real-time support, 10ms = 100Hz
         long t1 = millis();              ///> check timing
         return (t1 >= t0) ? (t0 = t1 + t0, 1) : 0;
     };
-    fout_setup();
+    fout_setup(hook);
 
-    bool resume = (VM==HOLD || VM==IO);  ///< check VM resume status
-    if (resume) IP = UINT(rs.pop());     /// * restore context
-    else fin_setup(line);                ///> refresh buffer if not resuming
+    bool resume = (VM_ST()==HOLD || VM_ST()==IO); ///< check VM resume status
+    if (resume) {
+        VM_IP() = UINT(VM_RS().pop());   /// * restore context
+        if (!VM_IP()) resume = false, VM_ST() = QUERY; /// * suspended at top level, parse on
+    }
+    else fin_setup(line, len);           ///> refresh buffer if not resuming
     
-    string idiom;
+    STK_CATCH(e);                        ///< guard page hit, frames below are gone
+    if (e) {
+        stk_err(e);
+        resume = false;
+#if DO_JIT
+        vm->_jdepth = 0;                 /// * JIT code frames went with them
+        if (vm->_jstale) { vm->_jstale = false; jit_flush(); }
+#endif // DO_JIT
+    }
+    Str idiom;
     while (resume || fetch(idiom)) {     /// * parse a word
-        if (resume) nest();                    /// * resume task
-        else        forth_core(idiom.c_str()); /// * send to Forth core
-        resume = VM==HOLD;
+        if (resume) nest();                        /// * resume task
+        else        forth_core(idiom.s, idiom.n);  /// * send to Forth core
+        STK_CHECK();
+#if DO_SCHECK
+        if ((U32)VM_SS().idx > (U32)VM_SS().sz) sfx_err(0); /// * top level built-ins, full depth
+#endif // DO_SCHECK
+        if (VM_ST()==IO) break;          /// * suspended (KEY, vm_wait)
+        resume = VM_ST()==HOLD;
         if (resume && time_up()) break;  ///> multi-threading support
     }
-    bool yield = VM==HOLD || VM==IO;     /// * yield to other tasks
+    STK_UNCATCH();
+    bool yield = VM_ST()==HOLD || VM_ST()==IO; /// * yield to other tasks
     
-    if (yield)         rs.push(IP);      /// * save context
-    else if (!compile) ss_dump();        /// * optionally display stack contents
+    if (yield)         { VM_RS().push(VM_IP()); fin_keep(); } /// * save context
+    else if (!VM_COMP()) ss_dump();      /// * optionally display stack contents
+#if DO_PROFILE
+    if (!yield) pdp = 0;                 /// * drop frames left by abort
+#endif // DO_PROFILE
+    fout_flush();                        /// * hand output to host
+    vm = v1; tk = t1;                    /// * restore caller's context
 
     return yield;
 }
-#include <iostream>
+int forth_vm(const char *line, void(*hook)(int, const char*), ForthVM *h) {
+    return vm_eval(line, strlen(line), hook, h);
+}
 void outer(istream &in) {
     string cmd;
     while (getline(in, cmd)) {                /// * read line-by-line
         while (forth_vm(cmd.c_str()));
     }
 }
+void outer(const char *buf, int n) {
+    for (const char *e = buf + n; buf < e; ) {  /// * line-by-line, in place
+        const char *p = (const char*)memchr(buf, '\n', e - buf);
+        int len = (int)((p ? p : e) - buf);
+        while (vm_eval(buf, len, NULL, NULL));
+        buf += len + 1;
+    }
+}
+///
+///> run a loaded script, preserve I/O states, call VM, restore IO states
+///
+void include_buf(const char *src, int n) {
+    void (*cb)(int, const char*) = VM_FOUTCB();   ///< keep output port
+    string in(VM_TIN(), VM_TEND() - VM_TIN());    ///< keep input buffer
+    VM_FOUT() << ENDL;                            /// * flush output
+
+    outer(src, n);
+
+    VM_FOUTCB() = cb;                             /// * restore output port
+    VM_TKEEP().swap(in); VM_KEPT() = true;        /// * restore input
+    VM_TIN() = VM_TKEEP().data(); VM_TEND() = VM_TIN() + VM_TKEEP().size();
+}
+#if DO_MAIN
 int  main(int ac, char* av[]) {
     forth_init();
     srand(time(0));
@@ -671,6 +2357,7 @@ int  main(int ac, char* av[]) {
     
     return 0;
 }
+#endif // DO_MAIN
 ///====================================================================
 ///
 ///@name IO functions
@@ -680,61 +2367,164 @@ int  main(int ac, char* av[]) {
 ///   * if it takes too much memory for target MCU,
 ///   * these functions can be replaced with our own implementation
 ///@{
-#include <iomanip>                  /// setbase, setw, setfill
-#include <sstream>                  /// iostream, stringstream
 using namespace std;                /// default to C++ standard template library
-istringstream   fin;                ///< forth_in
-ostringstream   fout;               ///< forth_out
-string          pad;                ///< input string buffer
-void (*fout_cb)(int, const char*);  ///< forth output callback function (see ENDL macro)
-
-void fin_setup(const char *line) {
-    fout.str("");                   /// * clean output buffer
-    fin.clear();                    /// * clear input stream error bit if any
-    fin.str(line);                  /// * reload user command into input stream
+void fin_setup(const char *line, int n) {
+    VM_TIN()  = line;               /// * parse caller's line in place
+    VM_TEND() = line + n;
+    VM_KEPT() = false;
+#if DO_TRACE
+    tk->_tr_ln = tk->_tr_n;         /// * errors dump this line's steps only
+#endif // DO_TRACE
+}
+void fin_keep() {                   ///< caller's line is gone after yield
+    if (VM_KEPT()) VM_TKEEP().erase(0, VM_TIN() - VM_TKEEP().data());
+    else           VM_TKEEP().assign(VM_TIN(), VM_TEND() - VM_TIN());
+    VM_TIN()  = VM_TKEEP().data();
+    VM_TEND() = VM_TIN() + VM_TKEEP().size();
+    VM_KEPT() = true;
 }
 void fout_setup(void (*hook)(int, const char*)) {
     auto cb = [](int, const char *rst) { printf("%s", rst); };
-    fout_cb = hook ? hook : cb;     ///< serial output hook up
+#if DO_MULTITASK
+    lock_guard<mutex> lk(vm->_omx); ///< tasks might be printing
+#endif // DO_MULTITASK
+    VM_FOUTCB() = hook ? hook : cb; ///< serial output hook up
 }
-char *scan(char c) { getline(fin, pad, c); return (char*)pad.c_str(); }
-int  fetch(string &idiom) { return !(fin >> idiom)==0; }
-
-void spaces(int n) { for (int i = 0; i < n; i++) fout << " "; }
+void fout_flush() { tk->_obuf.flush(); }
+void OutBuf::flush() {
+    int n = len();
+    if (!n || !VM_FOUTCB()) return;
+    *pptr() = '\0';                 /// * room reserved in buf
+    {
+#if DO_MULTITASK
+        lock_guard<mutex> lk(vm->_omx); ///< tasks share the output callback
+#endif // DO_MULTITASK
+        VM_FOUTCB()(n, pbase());    /// * in place, no copy
+    }
+    setp(buf, buf + E4_OUT_SZ);     /// * rewind
+}
+int OutBuf::overflow(int c) {
+    flush();
+    if (c != EOF) { *pptr() = (char)c; pbump(1); }
+    return c==EOF ? 0 : c;
+}
+int OutBuf::sync() {
+    if (len() >= E4_OUT_FLUSH) flush();
+    return 0;
+}
+Str scan(char c) {                  ///< up to c, c is consumed
+    const char *p = VM_TIN();
+    while (p < VM_TEND() && *p != c) p++;
+    Str t = { VM_TIN(), (int)(p - VM_TIN()) };
+    VM_TIN() = p < VM_TEND() ? p + 1 : p;
+    return t;
+}
+int fetch(Str &t) {                 ///< blank delimited, same as fin >> idiom
+    const char *p = VM_TIN();
+    while (p < VM_TEND() && (U8)*p <= ' ') p++;
+    t.s = p;
+    while (p < VM_TEND() && (U8)*p >  ' ') p++;
+    t.n = (int)(p - t.s);
+    VM_TIN() = p;
+    return t.n;
+}
+///
+///> number to string, digits are filled backward from the end of buf
+///  Note:
+///    * float: integral values are printed in radix b, others in decimal
+///      the same as %g (6 significant digits), exponent form by snprintf
+///
+char *ntoa(char *buf, DU v, int b) {
+    char *p = &buf[E4_NBUF - 1];
+    *p = '\0';
+    if (b < 2 || b > 36) b = 10;                /// * i.e. base ! with a float
+    auto digits = [&p](U64 n, int b) {          ///< unsigned, radix b
+        do {
+            int d = (int)(n % b); n /= b;
+            *--p = (char)(d > 9 ? (d - 10) + 'a' : d + '0');
+        } while (n);
+    };
+    bool neg = v < DU0;
+#if USE_FLOAT
+    static const U64 P10[] = {                  ///< exact 10^k
+        1, 10, 100, 1000, 10000, 100000, 1000000,
+        10000000, 100000000, 1000000000
+    };
+    static const double E10[] = { 1e-4, 1e-3, 1e-2, 1e-1, 1, 10, 100, 1e3, 1e4, 1e5 };
+    float a = neg ? -v : v;
+    if (a < 2147483648.0f && a == (float)(U32)a && (b != 10 || a < 1e6f)) {
+        digits((U32)a, b);                      /// * integral value
+    }
+    else if (a >= 1e-4f && a < 1e6f) {         /// * %g fixed form, exact
+        int e = 5;                              ///< decimal exponent
+        while (e > -4 && a < E10[e + 4]) e--;
+        int k  = 5 - e;                         ///< digits after point
+        int ex;
+        U64 m  = (U64)ldexpf(frexpf(a, &ex), 24); ///< a = m * 2^(ex-24)
+        int s  = 24 - ex;                       ///< always > 0 here
+        U64 pv = m * P10[k];
+        U64 q  = pv >> s, r = pv & ((1ULL << s) - 1), h = 1ULL << (s - 1);
+        if (r > h || (r == h && (q & 1))) q++;  /// * round half to even
+        if (q >= P10[6]) { q /= 10; k--; }      /// * rounded up to 10^(e+1)
+        if (q >= P10[6] || k < 0) {             /// * became 1e+06
+            snprintf(buf, E4_NBUF, "%g", v);
+            return buf;
+        }
+        for (; k > 0 && q % 10 == 0; k--) q /= 10;  /// * drop trailing zeros
+        for (int i = 0; i < k; i++) { *--p = (char)('0' + q % 10); q /= 10; }
+        if (k) *--p = '.';
+        digits(q, 10);
+    }
+    else {
+        snprintf(buf, E4_NBUF, "%g", v);  /// * exponent form
+        return buf;
+    }
+#else  // !USE_FLOAT
+    digits(neg ? (U64)(-(int64_t)v) : (U64)v, b);
+#endif // USE_FLOAT
+    if (neg) *--p = '-';
+    return p;
+}
+void spaces(int n) { for (int i = 0; i < n; i++) VM_FOUT().put(' '); }
 void put(io_op op, DU v, DU v2) {
+    char buf[E4_NBUF];
     switch (op) {
-    case BASE:  fout << setbase(*base = UINT(v));       break;
-    case BL:    fout << " ";                            break;
-    case CR:    fout << ENDL;                           break;
-    case DOT:   fout << v << " ";                       break;
-    case DOTR:  fout << setbase(*base)
-                     << setw(UINT(v)) << setw(v2);      break;
-    case EMIT:  { char b = (char)UINT(v); fout << b; }  break;
+    case BASE:  VM_FOUT() << setbase(*VM_BASE() = UINT(v));
+                DIRTY((U8*)VM_BASE() - MEM0, sizeof(IU));    break;
+    case BL:    VM_FOUT().put(' ');                          break;
+    case CR:    VM_FOUT() << ENDL;                           break;
+    case DOT: {
+        char *s = ntoa(buf, v, *VM_BASE());
+        VM_FOUT().write(s, strlen(s)).put(' ');
+    } break;
+    case DOTR: {
+        char *s = ntoa(buf, v2, *VM_BASE());
+        int  n  = (int)strlen(s);
+        spaces((int)UINT(v) - n);
+        VM_FOUT().write(s, n);
+    } break;
+    case EMIT:  VM_FOUT().put((char)UINT(v));                break;
     case SPCS:  spaces(UINT(v));                        break;
-    default:    fout << "unknown io_op=" << op << ENDL; break;
+    default:    VM_FOUT() << "unknown io_op=" << op << ENDL; break;
     }
 }
 void pstr(const char *str, io_op op) {
-    fout << str;
-    if (op==CR) fout << ENDL;
+    VM_FOUT().write(str, strlen(str));
+    if (op==CR) { VM_FOUT() << ENDL; }
 }
 ///@}
 ///====================================================================
 ///
 ///@name Debug functions
 ///@{
-#define TONAME(w) (dict[w].pfa - STRLEN(dict[w].name))
+#define TONAME(w) (VM_DICT()[w].pfa - STRLEN(VM_DICT()[w].name))
 ///
 ///> convert pfa to dictionary entry index
 ///
 int pfa2didx(IU ix) {                          ///> reverse lookup
     if (IS_PRIM(ix)) return (int)ix;           ///> primitives
-    IU pfa = ix & ~EXT_FLAG;                   ///> pfa (mask colon word)
-    for (int i = dict.idx - 1; i > 0; --i) {
-        if (ix & EXT_FLAG) {                   /// colon word?
-            if (dict[i].pfa == pfa) return i;  ///> compare pfa in PMEM
-        }
-        else if (dict[i].xtoff() == pfa) return i;   ///> compare xt (built-in words)
+    for (IU i = VM_RBKT()[REF_BKT(ix)]; i; i = VM_RNXT()[i]) {
+        if (VM_DREF()[i] == ix) return i;      /// * newest first, as a scan from top
     }
     return 0;                                  /// * not found
 }
@@ -747,8 +2537,8 @@ int  pfa2nvar(IU pfa) {
     
     IU  i0 = pfa2didx(pfa | EXT_FLAG);
     if (!i0) return 0;
-    IU  p1 = (i0+1) < dict.idx ? TONAME(i0+1) : HERE;
-    int n  = p1 - pfa - sizeof(IU) * (w==VAR ? 1 : 2);    ///> CC: calc # of elements
+    IU  p1 = (int)(i0+1) < VM_DICT().idx ? TONAME(i0+1) : HERE;
+    int n  = p1 - DALIGN(pfa + sizeof(IU) * (w==VAR ? 1 : 2));  ///> CC: calc # of elements
     return n;
 }
 ///
@@ -756,58 +2546,59 @@ int  pfa2nvar(IU pfa) {
 ///
 void to_s(IU w, U8 *ip) {
 #if CC_DEBUG
-    fout << setbase(16) << "( ";
-    fout << setfill('0') << setw(4) << (ip - MEM0);       ///> addr
-    fout << '[' << setfill(' ') << setw(4) << w << ']';   ///> word ref
-    fout << " ) " << setbase(*base);
+    VM_FOUT() << setbase(16) << "( ";
+    VM_FOUT() << setfill('0') << setw(4) << (ip - MEM0);  ///> addr
+    VM_FOUT() << '[' << setfill(' ') << setw(4) << w << ']'; ///> word ref
+    VM_FOUT() << " ) " << setbase(*VM_BASE());
 #endif // CC_DEBUG
     
     ip += sizeof(IU);                  ///> calculate next ip
     switch (w) {
-    case LIT:  fout << *(DU*)ip << " ( lit )";      break;
-    case STR:  fout << "s\" " << (char*)ip << '"';  break;
-    case DOTQ: fout << ".\" " << (char*)ip << '"';  break;
+    case LIT:  VM_FOUT() << CELL(DALIGN(ip - MEM0)) << " ( lit )";  break;
+    case LADD: VM_FOUT() << CELL(DALIGN(ip - MEM0)) << " ( lit+ )"; break;
+    case STR:  VM_FOUT() << "s\" " << (char*)ip << '"';  break;
+    case DOTQ: VM_FOUT() << ".\" " << (char*)ip << '"';  break;
     case VAR:
     case VBRAN: {
         int n  = pfa2nvar(UINT(ip - MEM0 - sizeof(IU)));
         IU  ix = (IU)(ip - MEM0 + (w==VAR ? 0 : sizeof(IU)));
         for (int i = 0, a=DALIGN(ix); i < n; i+=sizeof(DU)) {
-            fout << *(DU*)MEM(a + i) << ' ';
+            VM_FOUT() << *(DU*)MEM(a + i) << ' ';
         }
     }                                               /// no break, fall through
-    default: Code &c = DICT(w); fout << c.name;     break;
+    default: Code &c = DICT(w); VM_FOUT() << c.name;     break;
     }
     switch (w) {
     case NEXT: case LOOP:
     case BRAN: case ZBRAN: case VBRAN:             ///> display jmp target
-        fout << ' ' << setfill('0') << setbase(16)
+        VM_FOUT() << ' ' << setfill('0') << setbase(16)
              << setw(4) << *(IU*)ip;
         break;
+    case INEXT: case DZBRAN:                       ///> fused, target after hopped tokens
+        VM_FOUT() << ' ' << setfill('0') << setbase(16)
+             << setw(4) << *((IU*)ip + (w==INEXT ? 1 : 2));
+        break;
     default: /* do nothing */ break;
     }
-    fout << setfill(' ') << setw(-1);   ///> restore output format settings
+    VM_FOUT() << setfill(' ') << setw(-1); ///> restore output format settings
 }
 ///
 ///> Forth disassembler
 ///
 void see(IU pfa) {
     U8 *ip = MEM(pfa);
-    while (1) {
+    IU  i0 = pfa2didx(pfa | EXT_FLAG);
+    IU  p1 = (int)(i0+1) < VM_DICT().idx ? TONAME(i0+1) : HERE; ///< end of word
+    while (ip < MEM(p1)) {              /// * a tail call leaves no ; behind
         IU w = pfa2didx(*(IU*)ip);      ///> fetch word index by pfa
         if (!w) break;                  ///> loop guard
         
-        fout << ENDL; fout << "  ";     /// * indent
+        VM_FOUT() << ENDL; VM_FOUT() << "  "; /// * indent
         to_s(w, ip);                    /// * display opcode
         if (w==EXIT || w==VAR) return;  /// * end of word
         
-        ip += sizeof(IU);               ///> advance ip (next opcode)
-        switch (w) {                    ///> extra bytes to skip
-        case LIT:   ip += sizeof(DU);                    break; /// alignment?
-        case STR:   case DOTQ:  ip += STRLEN((char*)ip); break;
-        case BRAN:  case ZBRAN:
-        case NEXT:  case LOOP:  ip += sizeof(IU);        break;
-        case VBRAN: ip = MEM(*(IU*)ip);                  break;
-        }
+        if (w==VBRAN) { ip = MEM(*((IU*)ip + 1)); continue; }
+        ip += op_len(UINT(ip - MEM0));  ///> advance ip (next opcode)
     }
 }
 ///
@@ -816,9 +2607,9 @@ void see(IU pfa) {
 void words() {
     const int WIDTH = 60;
     int sz = 0;
-    fout << setbase(10);
-    for (int i=0; i<dict.idx; i++) {
-        const char *nm = dict[i].name;
+    VM_FOUT() << setbase(10);
+    for (int i=0; i<VM_DICT().idx; i++) {
+        const char *nm = VM_DICT()[i].name;
         const int  len = strlen(nm);
 #if CC_DEBUG > 1
         if (nm[0]) {
@@ -826,66 +2617,123 @@ void words() {
         if (nm[len-1] != ' ') {
 #endif // CC_DEBUG > 1
             sz += len + 2;
-            fout << "  " << nm;
+            VM_FOUT() << "  " << nm;
         }
         if (sz > WIDTH) {
             sz = 0;
-            fout << ENDL;
+            VM_FOUT() << ENDL;
             yield();
         }
     }
-    fout << setbase(*base) << ENDL;
+    VM_FOUT() << setbase(*VM_BASE()) << ENDL;
 }
 ///
 ///> show data stack content
 ///
 void ss_dump(bool forced) {
-    if (load_dp) return;                  /// * skip when including file
+    if (VM_LOADP()) return;               /// * skip when including file
 #if DO_WASM    
-    if (!forced) { fout << "ok" << ENDL; return; }
+    if (!forced) { VM_FOUT() << "ok" << ENDL; return; }
 #endif //    
-    static char buf[34];                  ///< static buffer
-    auto rdx = [](DU v, int b) {          ///< display v by radix
-#if USE_FLOAT
-        sprintf(buf, "%0.6g", v);
-        return buf;
-#else // !USE_FLOAT
-        int i = 33;  buf[i]='\0';         /// * C++ can do only base=8,10,16
-        DU  n = ABS(v);                   ///< handle negative
-        do {                              ///> digit-by-digit
-            U8 d = (U8)MOD(n,b);  n /= b;
-            buf[--i] = d > 9 ? (d-10)+'a' : d+'0';
-        } while (n && i);
-        if (v < DU0) buf[--i]='-';
-        return &buf[i];
-#endif // USE_FLOAT
-    };
-    ss.push(tos);
-    for (int i=0; i<ss.idx; i++) {
-        fout << rdx(ss[i], *base) << ' ';
+    char buf[E4_NBUF];
+    VM_SS().push(VM_TOS());
+    for (int i=0; i<VM_SS().idx; i++) {
+        VM_FOUT() << ntoa(buf, VM_SS()[i], *VM_BASE()) << ' ';
     }
-    tos = ss.pop();
-    fout << "-> ok" << ENDL;
+    VM_TOS() = VM_SS().pop();
+    VM_FOUT() << "-> ok" << ENDL;
 }
 ///
 ///> dump memory content range from [p0, p0+sz)
 ///
 void mem_dump(U32 p0, IU sz) {
-    fout << setbase(16) << setfill('0');
+    VM_FOUT() << setbase(16) << setfill('0');
     for (IU i=ALIGN16(p0); i<=ALIGN16(p0+sz); i+=16) {
-        fout << setw(4) << i << ": ";
+        VM_FOUT() << setw(4) << i << ": ";
         for (int j=0; j<16; j++) {
-            U8 c = pmem[i+j];
-            fout << setw(2) << (int)c << (MOD(j,4)==3 ? " " : "");
+            U8 c = VM_PMEM()[i+j];
+            VM_FOUT() << setw(2) << (int)c << (MOD(j,4)==3 ? " " : "");
         }
         for (int j=0; j<16; j++) {   // print and advance to next byte
-            U8 c = pmem[i+j] & 0x7f;
-            fout << (char)((c==0x7f||c<0x20) ? '_' : c);
+            U8 c = VM_PMEM()[i+j] & 0x7f;
+            VM_FOUT() << (char)((c==0x7f||c<0x20) ? '_' : c);
         }
-        fout << ENDL;
+        VM_FOUT() << ENDL;
         yield();
     }
-    fout << setbase(*base) << setfill(' ');
+    VM_FOUT() << setbase(*VM_BASE()) << setfill(' ');
+}
+///
+///> display dictionary attributes
+///
+void dict_dump() {
+    VM_FOUT() << setbase(16) << setfill('0') << "XTN=" << Code::XTN << ENDL;
+    for (int i=0; i<VM_DICT().idx; i++) {
+        Code &c = VM_DICT()[i];
+        VM_FOUT() << setfill('0') << setw(3) << i
+             << "> attr=" << (c.attr & 0x3)
+             << ", xt="   << setw(4) << c.pfa
+             << ":"       << setw(8) << (IS_UDF(i) ? 0 : (UFP)Code::XT(c.pfa))
+             << ", name=" << setw(8) << (UFP)c.name
+             << " "       << c.name << ENDL;
+    }
+    VM_FOUT() << setbase(*VM_BASE()) << setfill(' ') << setw(-1);
+}
+///
+///> show memory statistics
+///
+void mem_stat() {
+    VM_FOUT() << APP_VERSION
+         << "\n  dict: " << VM_DICT().idx  << "/" << E4_DICT_SZ
+         << "\n  ss  : " << VM_SS().idx    << "/" << VM_SS().sz << " (max " << VM_SS().max
+         << ")\n  rs  : " << VM_RS().idx   << "/" << VM_RS().sz << " (max " << VM_RS().max
+         << ")\n  mem : " << HERE     << "/" << E4_PMEM_SZ << ENDL;
+}
+///
+///> display profiler report, sorted by exclusive time
+///
+void prof_dump() {
+#if DO_PROFILE
+    static IU ix[E4_DICT_SZ];
+    int n = 0;
+    for (int i = 1; i < VM_DICT().idx; i++) { /// * insertion sort by t_ex
+        if (!prof[i].n) continue;
+        int j = n++;
+        for (; j > 0 && prof[ix[j-1]].t_ex < prof[i].t_ex; --j) ix[j] = ix[j-1];
+        ix[j] = i;
+    }
+    VM_FOUT() << setbase(10) << "     calls    incl(us)    excl(us)  name" << ENDL;
+    for (int k = 0; k < n; k++) {
+        Prof &p = prof[ix[k]];
+        VM_FOUT() << setw(10) << p.n
+             << setw(12) << p.t_in / 1000
+             << setw(12) << p.t_ex / 1000
+             << "  " << VM_DICT()[ix[k]].name << ENDL;
+        yield();
+    }
+    VM_FOUT() << setbase(*VM_BASE()) << setw(-1);
+#endif // DO_PROFILE
+}
+///
+///> display last n nest() steps of current task, oldest first
+///
+void trace_dump(int n, bool line) {
+#if DO_TRACE
+    U32 e = tk->_tr_n;                    ///< snapshot, the ring may move on
+    if (n > E4_TRACE_SZ) n = E4_TRACE_SZ;
+    U32 i = e > (U32)n ? e - n : 0;
+    if (line && i < tk->_tr_ln) i = tk->_tr_ln; /// * nothing left from earlier lines
+    VM_FOUT() << setbase(16) << setfill('0');
+    for (; i < e; i++) {
+        TraceRec &r = tk->_tr[i & (E4_TRACE_SZ - 1)];
+        IU w = pfa2didx(r.op);            ///< word index, as see does
+        VM_FOUT() << "  [" << setw(4) << r.ip << "]:" << setw(4) << r.op
+             << " ss=" << r.sdp << " rs=" << r.rdp
+             << " tos=" << r.top << ' '
+             << (w || IS_PRIM(r.op) ? DICT(w).name : "?") << ENDL;
+    }
+    VM_FOUT() << setbase(*VM_BASE()) << setfill(' ') << setw(-1);
+#endif // DO_TRACE
 }
 ///@}
 ///====================================================================
@@ -893,59 +2741,211 @@ void mem_dump(U32 p0, IU sz) {
 ///@name WASM/Emscripten ccall interfaces
 ///@{
 #if DO_WASM
+///
+///> VM handle, 0 selects the default VM (i.e. vm0)
+///
+#define VM_OF(h)  ((h) ? (h) : vm0)
+///
+///> refresh VM state header, VM idle (see VMHdr)
+///
+///  Note: in the shared memory build (make coi), front-end reads stack
+///        and memory through the header directly, no serialization
+///
+static ForthVM *vm_sync(ForthVM *v) {
+    VMHdr &h = v->_hdr;
+    h.magic    = 0x4d563445;                    /// * 'E4VM'
+    h.ss_adr   = (U32)(UFP)&v->_ss[0];
+    h.ss_idx   = v->_ss.idx;
+    h.tos_adr  = (U32)(UFP)&v->_tos;
+    h.mem_adr  = (U32)(UFP)&v->_pmem[0];        /// * VMem may move on grow
+    h.mem_idx  = v->_pmem.idx;
+    h.radix    = *v->_base;
+    h.dfloat   = *v->_dflt;
+    h.dict_idx = v->_dict.idx;
+    h.dict_gen = v->_dgen;
+    ForthVM *v1 = vm; vm = v;
+    U8 *f = frame_buf(false);
+    vm = v1;
+    h.frm_adr  = f ? (U32)(UFP)f : 0;
+    h.frm_n    = v->_frm_n;
+    h.frm_seq  = v->_frm_seq;
+    h.seq      = (h.seq | 1) + 1;               /// * even, readable
+    return v;
+}
+///
+///> suspend VM until JS wakes it up, i.e. vm_wake
+///
+///  Note: * w is passed to vm_suspend() of the worker, which queues a
+///          timer, a fetch or a key request and returns at once, so the
+///          worker thread is back to its event loop instead of blocking
+///        * top level (VM==QUERY) has no IP to save, parse on at resume
+///        * included files run to the end (outer), and pages without
+///          vm_suspend (ceforth.html, eforth.html) block as before, 0 returned
+///
+int vm_wait(vm_wait_t w, U32 arg, const char *fn) {
+    if (VM_LOADP()) return 0;                   /// * nested in an included file
+    if (w==WAIT_JS && millis() - vm->_wt < E4_SLICE) return 0;  /// * JS yields once a slice
+    int ok = EM_ASM_INT({
+        return typeof vm_suspend=='function'
+            ? vm_suspend($0, $1, $2, $3 ? UTF8ToString($3) : '') : 0;
+        }, vm==vm0 ? 0 : vm, w, arg, fn);
+    if (!ok) return 0;
+    if (VM_ST()==QUERY) VM_IP() = 0;            /// * top level, see vm_eval
+    VM_ST() = IO;
+    vm->_wait = w;
+    return 1;
+}
 extern "C" {
-int  forth(int n, char *cmd) {
-    return (n==1) ? (PUSH(cmd[0]), 0) : forth_vm(cmd);
+///
+///> run cmd (n=0) or push keypress (n=1) into VM h
+///> return 0: done, 1: held (resend to resume), 2: suspended (see vm_wait)
+///
+int  forth(ForthVM *h, int n, char *cmd) {
+    ForthVM *v = VM_OF(h);
+    v->_hdr.seq |= 1;                           /// * odd, VM running
+    if (n!=1) {
+        v->_wt = millis();
+        int r = forth_vm(cmd, NULL, v);
+        vm_sync(v);
+        return v->_wait ? 2 : r;
+    }
+    ForthVM *p = vm;                            ///< keypress into VM h
+    tk = vm = v; PUSH(cmd[0]); tk = vm = p;
+    vm_sync(v);
+    return 0;
 }
-int  vm_tos()        { return tos;      }
-int  vm_base()       { return *base;    }
-int  vm_dflt()       { return *dflt;    }
-int  vm_ss_idx()     { return ss.idx;   }
-int  vm_dict_idx()   { return dict.idx; }
-int  vm_mem_idx()    { return pmem.idx; }       // HERE
-DU   *vm_ss()        { return &ss[0];   }
-char *vm_dict(int i) { return (char*)dict[i].name; }
-char *vm_mem()       { return (char*)&pmem[0]; }
+VMHdr *vm_hdr(ForthVM *h)         { return &vm_sync(VM_OF(h))->_hdr; }
+///
+///> 16-byte lines of pmem[off, off+len) written since last asked
+///> out[max]: line offsets, return count, their bits are cleared
+///> -1: not tracked (USE_DIRTY 0), caller redraws all
+///
+int vm_dirty(ForthVM *h, U32 off, U32 len, U32 *out, int max) {
+#if DO_DIRTY
+    ForthVM *v1 = vm;                           ///< keep caller's context
+    vm = VM_OF(h);
+    if (vm->_dlo < HERE) DIRTY(vm->_dlo, HERE - vm->_dlo);  /// * appended since
+    vm->_dlo = HERE;
+    U32 e = off + len > E4_PMEM_SZ ? E4_PMEM_SZ : off + len;
+    int n = 0;
+    for (U32 l = off >> 4; n < max && (l << 4) < e; l++) {
+        U8 &b = vm->_dmap[l >> 3], m = 1 << (l & 7);
+        if (b & m) { b &= ~m; out[n++] = l << 4; }
+    }
+    vm = v1;
+    return n;
+#else  // !DO_DIRTY
+    return -1;
+#endif // DO_DIRTY
 }
 ///
-///> input from Web/console
+///> last nest() steps of VM h into out[max], oldest first
+///> return count, 0: not traced (DO_TRACE 0)
 ///
-void key() {
-    EM_ASM({ postMessage(['key', 1]); });       /// set keypress mode
+int vm_trace(ForthVM *h, TraceRec *out, int max) {
+#if DO_TRACE
+    ForthVM *v = VM_OF(h);
+    U32 e = v->_tr_n;                           ///< snapshot, see TRACE
+    if (max > E4_TRACE_SZ) max = E4_TRACE_SZ;
+    int n = 0;
+    for (U32 i = e > (U32)max ? e - max : 0; i < e; i++) {
+        out[n++] = v->_tr[i & (E4_TRACE_SZ - 1)];
+    }
+    return n;
+#else  // !DO_TRACE
+    return 0;
+#endif // DO_TRACE
 }
 ///
-///> display dictionary attributes
+///> resume a suspended VM, src: fetched script (malloc'ed by JS) for WAIT_LOAD
 ///
-void dict_dump() {
-    fout << setbase(16) << setfill('0') << "XT0=" << Code::XT0 << ENDL;
-    for (int i=0; i<dict.idx; i++) {
-        Code &c = dict[i];
-        fout << setfill('0') << setw(3) << i
-             << "> attr=" << (c.attr & 0x3)
-             << ", xt="   << setw(4) << (IS_UDF(i) ? c.pfa : c.xtoff())
-             << ":"       << setw(8) << (UFP)c.xt
-             << ", name=" << setw(8) << (UFP)c.name
-             << " "       << c.name << ENDL;
+int vm_wake(ForthVM *h, char *src) {
+    ForthVM *v1 = vm;                           ///< keep caller's context
+    Task    *t1 = tk;
+    tk = vm = VM_OF(h);
+    if (vm->_wait==WAIT_LOAD) {
+        if (!src) VM_FOUT() << "included: load failed!" << ENDL;
+        else {                                  /// * as load(), IP already on rs
+            VM_LOADP()++;
+            VM_ST() = NEST;
+            include_buf(src, (int)strlen(src));
+            --VM_LOADP();
+            VM_ST() = IO;
+        }
     }
-    fout << setbase(*base) << setfill(' ') << setw(-1);
+    vm->_wait = WAIT_NONE;
+    vm = v1; tk = t1;
+    free(src);
+    return forth(h, 0, (char*)"");              /// * resume, see vm_eval
+}
+ForthVM *vm_create(int ss_sz, int rs_sz) {  ///< stack sizes, 0: default
+    return forth_new(ss_sz ? ss_sz : E4_SS_SZ, rs_sz ? rs_sz : E4_RS_SZ);
 }
+void  vm_destroy(ForthVM *h)      { forth_free(h); }
+DU    *vm_tos(ForthVM *h)         { return &VM_OF(h)->_tos;          }
+int   vm_base(ForthVM *h)         { return *VM_OF(h)->_base;         }
+int   vm_dflt(ForthVM *h)         { return *VM_OF(h)->_dflt;         }
+int   vm_ss_idx(ForthVM *h)       { return VM_OF(h)->_ss.idx;        }
+int   vm_dict_idx(ForthVM *h)     { return VM_OF(h)->_dict.idx;      }
+int   vm_mem_idx(ForthVM *h)      { return VM_OF(h)->_pmem.idx;      }  // HERE
+DU    *vm_ss(ForthVM *h)          { return &VM_OF(h)->_ss[0];        }
+char  *vm_dict(ForthVM *h, int i) { return (char*)VM_OF(h)->_dict[i].name; }
 ///
-///> show memory statistics
+///> words from dict[from] on, packed into buf[max] for the vocabulary views
+///> DictHdr, then per word: U32 pfa, U8 flags (1: udf, 2: imm), U8 len, name
+///> start < from: words were cut or changed (forget, boot, is), drop them first
+///> return bytes used, call again from start+n if n short of idx-start
 ///
-void mem_stat() {
-    fout << APP_VERSION
-         << "\n  dict: " << dict.idx  << "/" << E4_DICT_SZ
-         << "\n  ss  : " << ss.idx    << "/" << E4_SS_SZ << " (max " << ss.max
-         << ")\n  rs  : " << rs.idx   << "/" << E4_RS_SZ << " (max " << rs.max
-         << ")\n  mem : " << HERE     << "/" << E4_PMEM_SZ << endl;
+int vm_dict_pack(ForthVM *h, int from, U8 *buf, int max) {
+    ForthVM *v = VM_OF(h);
+    int w = from < (int)v->_dcut ? from : (int)v->_dcut;
+    if (w > v->_dict.idx) w = v->_dict.idx;
+    v->_dcut = v->_dict.idx;                    /// * reported
+    DictHdr d = { v->_dgen, (U32)w, (U32)v->_dict.idx, 0 };
+    int sz = sizeof(d);
+    for (; w < v->_dict.idx; w++, d.n++) {
+        Code &c = v->_dict[w];
+        int  n  = (int)strlen(c.name);
+        if (n > 255) n = 255;
+        if (sz + (int)sizeof(U32) + 2 + n > max) break;   /// * full, rest next call
+        U32 pfa = (c.attr & UDF_ATTR) ? c.pfa : 0;
+        memcpy(buf + sz, &pfa, sizeof(U32)); sz += sizeof(U32);
+        buf[sz++] = (U8)(c.attr & (UDF_ATTR | IMM_ATTR));
+        buf[sz++] = (U8)n;
+        memcpy(buf + sz, c.name, n); sz += n;
+    }
+    memcpy(buf, &d, sizeof(d));
+    return sz;
+}
+char  *vm_mem(ForthVM *h)         { return (char*)&VM_OF(h)->_pmem[0]; }
+///
+///> image snapshot, buf is malloc'ed by JS (e.g. from a fetched ArrayBuffer)
+///
+int vm_image(ForthVM *h, U8 *buf, int n, int save) {
+    ForthVM *v1 = vm;                           ///< keep caller's context
+    Task    *t1 = tk;
+    tk = vm = VM_OF(h);
+    int r = save ? forth_image_save(buf, n) : forth_image_load(buf, n);
+    vm = v1; tk = t1;
+    vm_sync(VM_OF(h));
+    return r;
+}
+}
+///
+///> input from Web/console
+///
+void key() {
+    if (vm_wait(WAIT_KEY)) return;              /// * worker asks front-end for a key
+    EM_ASM({                                    /// set keypress mode
+        typeof vm_post=='function' ? vm_post(['key', 1]) : postMessage(['key', 1]);
+    });
 }
 ///
 ///> Javascript web worker message sender
 ///
-EM_JS(void, js_call, (const char *ops), {
+EM_JS(void, js_call, (U8 *mem, const char *ops), {
         const req = UTF8ToString(ops).split(/\\s+/);
         const wa  = wasmExports;
-        const mem = wa.vm_mem();
         let msg = [Date.now()], tfr = [];       ///< t0 anchor for performance
         for (let i=0, n=req.length; i < n; i++) {
             if (req[i]=='p') {
@@ -961,7 +2961,8 @@ EM_JS(void, js_call, (const char *ops), {
             }
             else msg.push(req[i]);
         }
-        postMessage(['js', msg], tfr);
+        typeof vm_post=='function'              /// * worker may be batching
+            ? vm_post(['js', msg], tfr) : postMessage(['js', msg], tfr);
 });
 ///
 ///> Javascript Native Interface, before passing to js_call()
@@ -990,63 +2991,237 @@ void native_api() {                        ///> ( n addr u -- )
         return n.str();
     };
     POP();                                 /// * strlen, not used
-    pad.clear();                           /// * borrow PAD for string op
-    pad.append((char*)MEM(POP()));         /// copy string on stack
-    for (size_t i=pad.find_last_of('%');   ///> find % from back
+    VM_PAD().clear();                      /// * borrow PAD for string op
+    VM_PAD().append((char*)MEM(POP()));    /// copy string on stack
+    for (size_t i=VM_PAD().find_last_of('%'); ///> find % from back
          i!=string::npos;                  /// * until not found
-         i=pad.find_last_of('%',i?i-1:0)) {
-        if (i && pad[i-1]=='%') {          /// * double %%
-            pad.replace(--i,1,"");         /// * drop one %
+         i=VM_PAD().find_last_of('%',i?i-1:0)) {
+        if (i && VM_PAD()[i-1]=='%') {     /// * double %%
+            VM_PAD().replace(--i,1,"");    /// * drop one %
         }
-        else pad.replace(i, 2, t2s(pad[i+1]));
+        else VM_PAD().replace(i, 2, t2s(VM_PAD()[i+1]));
     }
-    js_call(pad.c_str());    /// * pass to Emscripten function above
+    js_call(MEM0, VM_PAD().c_str()); /// * pass to Emscripten function above
+}
+///
+///> JSB records to Javascript, decoded into the same ['js', [t0, op, ...]]
+///> messages the string interface gives, blocks copied once as typed arrays
+///
+EM_JS(void, js_bcall, (U8 *mem, int off, int len, int fp, int done), {
+        const buf = wasmExports.memory.buffer;
+        const u32 = new Uint32Array(buf, mem + off, len >> 2);
+        const i32 = new Int32Array(buf, mem + off, len >> 2);
+        const f32 = new Float32Array(buf, mem + off, len >> 2);
+        const ops = Module.jsb_op || (Module.jsb_op = new Map()); ///< fmt tokens by hash
+        const q   = Module.jsb_q  || (Module.jsb_q  = []);        ///< calls collected
+        const tfr = Module.jsb_t  || (Module.jsb_t  = []);        ///< and their buffers
+        for (let i = 0; i < u32.length; i += 3 + u32[i+2]) {
+            let tk = ops.get(u32[i+1]);
+            if (!tk) {                          /// * parse fmt once per content
+                tk = UTF8ToString(mem + u32[i]).split(/\\s+/).filter(t=>t);
+                ops.set(u32[i+1], tk);
+            }
+            let j = i + 3;
+            const arg = (c)=>{                  ///< next argument by type
+                switch (c) {
+                case 'd': return i32[j++];
+                case 'f': return fp ? f32[j++] : i32[j++];
+                case 's': return UTF8ToString(mem + u32[j++]);
+                case 'p': case 'b':             /// * (offset, length, dtype) view
+                    const a = u32[j+2]
+                        ? new Uint8Array(buf,   mem + u32[j], u32[j+1])
+                        : new Float32Array(buf, mem + u32[j], u32[j+1]);
+                    j += 3;
+                    const t = a.slice();        /// * own copy, transferable
+                    tfr.push(t.buffer);
+                    return t;
+                default: return u32[j++];       /// * 'x', and unknown
+                }
+            };
+            let msg = [Date.now()];             ///< t0 anchor for performance
+            tk.forEach(t=>msg.push(
+                t.length==2 && t[0]=='%' && t[1]!='%'
+                ? arg(t[1])
+                : t.replace(/%(.)/g, (m, c)=>c=='%' ? '%' : String(arg(c)))));
+            q.push(['js', msg]);
+        }
+        if (!done || !q.length) return;
+        const m = q.length==1 ? q[0] : ['bat', q.slice()];
+        const t = tfr.slice();
+        q.length = tfr.length = 0;
+        typeof vm_post=='function'              /// * worker may be batching
+            ? vm_post(m, t) : postMessage(m, t);
+});
+///
+///> Binary Javascript interface, fmt as JS but nothing formatted here
+///
+///  Record appended at pmem[JSR_AREA + _jsr_n], U32 cells:
+///    op   - address of fmt, e.g. s" ..." literal or a temporary
+///    h    - FNV-1a of the fmt bytes, JS parses a fmt once and caches
+///           it by this, so another fmt at the same op is parsed again
+///    n    - argument cells that follow
+///    ...  - in fmt order, %d %x %f are one cell, %s its address,
+///           %p (f32) and %b (u8) blocks (offset, length, dtype)
+///
+///  Each record is decoded as it is appended, so %p/%b blocks and %s
+///  strings are copied before Forth refills them (e.g. one px buffer
+///  reused by every call of a JS[ ... ]JS batch); the messages go at
+///  once, or at ]JS when JS[ started a batch
+///
+void native_bin() {                        ///> ( ... a u -- )
+    U32  u  = UINT(POP());                 ///< fmt length
+    IU   op = UINT(POP());
+    const char *f = (const char*)MEM(op);
+    char ty[E4_JSR_SZ / sizeof(U32)];      ///< argument types, in fmt order
+    U32  h  = 2166136261u;                 ///< fmt content key, see js_bcall
+    for (U32 i = 0; i < u; i++) h = (h ^ (U8)f[i]) * 16777619u;
+    int  k  = 0, n = 0;
+    for (const char *p = f; (p = strchr(p, '%')) && p[1]; p += 2) {
+        if (p[1]=='%') continue;           /// * %% is a literal
+        ty[k++] = p[1];
+        n += (p[1]=='p' || p[1]=='b') ? 3 : 1;
+        if (n + 3 > E4_JSR_SZ / (int)sizeof(U32)) {
+            pstr("JSB: too many args", CR); return;
+        }
+    }
+    int sz = (n + 3) * sizeof(U32);
+    U32 *r = (U32*)MEM(JSR_AREA + vm->_jsr_n);
+    U32 *a = r + 3 + n;                    ///< filled from the back, TOS is the last %
+    r[0] = op;
+    r[1] = h;
+    r[2] = n;
+    while (k--) {
+        switch (ty[k]) {
+        case 'p': case 'b':
+            *--a = ty[k]=='b';                     /// * dtype, 0:f32 1:u8
+            a   -= 2;
+            a[0] = UINT(POP());                    /// * offset
+            a[1] = UINT(POP());                    /// * length
+            break;
+        case 'f': { DU v = POP(); memcpy(--a, &v, sizeof(U32)); } break;
+        case 's': POP(); *--a = UINT(POP());       break;
+        case 'd': *--a = (U32)(S32)POP();          break;
+        default : *--a = UINT(POP());              break;
+        }
+    }
+    DIRTY(JSR_AREA + vm->_jsr_n, sz);
+    vm->_jsr_n += sz;
+    js_flush(!vm->_jsr_b);                 /// * decode now, post unless batching
+}
+void js_flush(bool done) {
+    js_bcall(MEM0, JSR_AREA, vm->_jsr_n, USE_FLOAT, done);
+    vm->_jsr_n = 0;
+}
+///
+///> frame pipeline, two buffers of _frm_sz slots at pmem[_frm]
+///
+///  Forth fills the back buffer (frame), frame-swap publishes it and the
+///  worker ships the front one once per animation frame (see vm_frame in
+///  weforth_worker.js), so a half-written frame is never shown
+///
+U8 *frame_buf(bool back) {
+    IU sz = vm->_frm_sz * E4_FRM_SLOT * sizeof(DU);
+    if (!vm->_frm || vm->_frm + 2 * sz > HERE) return 0;   /// * none, or forgotten
+    return MEM(vm->_frm + (vm->_frm_b ^ !back) * sz);
 }
 ///
 ///> External file loader
 ///
 int  forth_include(const char *fn) {              ///> include with Javascript
-    static int bidx = E4_PMEM_SZ;                 ///< read buffer index
-    const  int rst  = EM_ASM_INT({
+    const int len = EM_ASM_INT({
         const txt = sync_fetch($0);               ///< fetch file from server subdir
-        if (!txt) return 0;
-        
-        const len = txt.length + 1;               ///< script + '\0'
-        const adj = (len + 0x10) & ~0xf;          ///< adjusted length, 16-byte aligned
-        const wa  = wasmExports;                  ///< WASM export block
-        const adr = wa.vm_mem() + $1 - adj;       ///< memory address from rear
-        const buf = new Uint8Array(wa.memory.buffer, adr, len);
-        for (var i=0; i < len; i++) {
-            buf[i] = txt.charCodeAt(i);
-        }
-        buf[len-1] = '\0';                        /// * \0 terminated str
-        
-        return adj;
-        }, fn, bidx);
-    if (rst==0) {
-        fout << fn << " load failed!" << ENDL;    /// * fetch failed, bail
+        if (!txt) return -1;
+        Module.e4_src = new TextEncoder().encode(txt);  /// * UTF-8 bytes
+        return Module.e4_src.length;
+        }, fn);
+    if (len < 0) {
+        VM_FOUT() << fn << " load failed!" << ENDL; /// * fetch failed, bail
         return 0;
     }
-    bidx -= rst;                                  /// * buffer allocated
-    ///
-    /// preserve I/O states, call VM, restore IO states
-    ///
-    void (*cb)(int, const char*) = fout_cb;       ///< keep output port
-    string in; getline(fin, in);                  ///< keep input buffer
-    fout << ENDL;                                 /// * flush output
-
-    struct strbuf : public streambuf {            ///> in-place buffer
-        strbuf(char *s, size_t n) { setg(s, s, s+n); }
+    char *src = (char*)malloc(len + 1);           ///< WASM heap, not pmem
+    if (!src) {
+        VM_FOUT() << fn << " too large!" << ENDL;
+        return 0;
     }
-    strbuf((char*)&pmem[bidx], rst);              ///< create in-place string buf
-    istream ss(&strbuf);                          ///< attach string to stream
-    outer(ss);
-
-    bidx += rst;                                  /// * release buffer
-    fout_cb = cb;                                 /// * restore output port
-    fin.clear(); fin.str(in);                     /// * restore input
+    EM_ASM({
+        HEAPU8.set(Module.e4_src, $0);            /// * bulk copy
+        HEAPU8[$0 + $1] = 0;                      /// * \0 terminated str
+        Module.e4_src = null;
+        }, src, len);
+    include_buf(src, len);
+    free(src);
     
     return 0;
 }
 ///@}
-#endif // DO_WSAM
+#else  // !DO_WASM
+///
+///@name Native console interfaces
+///@{
+///
+///> input from console
+///
+void key() { PUSH(cin.get()); }
+///
+///> External file loader
+///
+int  forth_include(const char *fn) {              ///> include from file
+#if _WIN32 || _WIN64
+    ifstream ifs(fn, ios::binary);
+    if (!ifs.is_open()) {
+        VM_FOUT() << fn << " load failed!" << ENDL; /// * open failed, bail
+        return 0;
+    }
+    string src((istreambuf_iterator<char>(ifs)), istreambuf_iterator<char>());
+    include_buf(src.data(), (int)src.size());
+#else  // !(_WIN32 || _WIN64)
+    int fd = open(fn, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        if (fd >= 0) close(fd);
+        VM_FOUT() << fn << " load failed!" << ENDL; /// * open failed, bail
+        return 0;
+    }
+    size_t n   = (size_t)st.st_size;
+    void   *src = n ? mmap(0, n, PROT_READ, MAP_PRIVATE, fd, 0) : 0;
+    close(fd);                                    /// * mapping stays valid
+    if (src == MAP_FAILED) {
+        VM_FOUT() << fn << " mmap failed!" << ENDL;
+        return 0;
+    }
+    if (n) {
+        madvise(src, n, MADV_SEQUENTIAL);
+        include_buf((const char*)src, (int)n);    /// * parsed in place, no copy
+        munmap(src, n);
+    }
+#endif // _WIN32 || _WIN64
+    
+    return 0;
+}
+///
+///> Image file save/load, see forth_image_save
+///
+int  forth_image_file(const char *fn, bool save) {
+    FILE *f = fopen(fn, save ? "wb" : "rb");
+    if (!f) {
+        VM_FOUT() << fn << (save ? " save" : " load") << " failed!" << ENDL;
+        return 0;
+    }
+    vector<U8> img;
+    int ok = 0;
+    if (save) {
+        img.resize(forth_image_save(NULL, 0));
+        forth_image_save(img.data(), (int)img.size());
+        ok = fwrite(img.data(), 1, img.size(), f) == img.size();
+    }
+    else {
+        fseek(f, 0, SEEK_END); img.resize(ftell(f)); rewind(f);
+        ok = fread(img.data(), 1, img.size(), f) == img.size()
+            && forth_image_load(img.data(), (int)img.size());
+    }
+    fclose(f);
+    if (!ok) VM_FOUT() << fn << " bad image!" << ENDL;
+    return ok;
+}
+///@}
+#endif // DO_WASM
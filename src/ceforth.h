@@ -3,7 +3,15 @@
 #include <cstdio>
 #include <cstdint>      // uintxx_t
 #include <string>       // string, strlen
+#include <ostream>      // ostream, streambuf
 #include "config.h"     // configuation and cross-platform support
+#if DO_MULTITASK
+#include <atomic>       // task completion flag
+#include <mutex>        // output and task table locks
+#define E4_TLS     thread_local     /**< VM context per worker thread */
+#else  // !DO_MULTITASK
+#define E4_TLS                      /**< single-threaded VM context   */
+#endif // DO_MULTITASK
 using namespace std;
 ///
 /// array class template (so we don't have dependency on C++ STL)
@@ -46,88 +54,161 @@ struct List {
     void clear(int i=0)    INLINE { idx=i; }
 };
 ///
+/// data and return stacks, sized per VM at run time (see forth_new, stacks)
+/// Note:
+///   * same interface as List<DU, N>, v, idx and max are also used by the JIT
+///   * DO_STKPAGE: the top cell sits against a PROT_NONE page, so a push
+///     past it faults and the fault is turned into an abort (see stk_sig)
+///   * DO_STKPAD: E4_STK_PAD sentinel cells on both ends, checked each
+///     time nest() returns to the outer loop (see stk_check)
+///
+struct Stack {
+    DU  *v   = 0;       ///< cells
+    int idx  = 0;       ///< current index of array
+    int max  = 0;       ///< high watermark for debugging
+    int sz   = 0;       ///< cells usable
+    U8  *blk = 0;       ///< allocated block, guards or sentinels included
+    int bsz  = 0;       ///< its size in bytes
+
+    Stack(int n)  { resize(n); }
+    ~Stack()      { release(); }
+    Stack(const Stack&)            = delete;  ///< owns blk, no copies
+    Stack &operator=(const Stack&) = delete;
+    void resize(int n);                 ///< reallocate n cells, contents dropped
+    void release();
+    int  guard(const void *a) const;    ///< a in guard page, 1: above, -1: below
+    int  bad() const;                   ///< sentinel hit, 1: above, -1: below
+    void arm();                         ///< (re)set sentinels
+
+    DU   &operator[](int i) INLINE { return i < 0 ? v[idx + i] : v[i]; }
+
+#if RANGE_CHECK
+    DU pop()     INLINE {
+        if (idx>0) return v[--idx];
+        throw "ERR: Stack empty";
+    }
+    DU push(DU t) INLINE {
+        if (idx<sz) return v[max=idx++] = t;
+        throw "ERR: Stack full";
+    }
+
+#else  // !RANGE_CHECK
+    DU pop()     INLINE { return v[--idx]; }
+    DU push(DU t) INLINE { return v[max=idx++] = t; }
+
+#endif // RANGE_CHECK
+    void clear(int i=0)    INLINE { idx=i; }
+};
+#if USE_IU32
+#include <cstring>      // memcpy
+///
+/// growable parameter memory (USE_IU32), same interface as List<U8, N>
+/// Note:
+///   * E4_PMEM_SZ of address space is reserved once, and pages are
+///   * committed by E4_PMEM_STEP as HERE grows, so pointers into
+///   * pmem (word names, base, dflt) never move
+///
+struct VMem {
+    U8  *v;             ///< base of reserved range
+    int idx = 0;        ///< current index of array
+    int max = 0;        ///< high watermark for debugging
+    int cap = 0;        ///< bytes committed
+
+    VMem();
+    ~VMem();
+    VMem(const VMem&)            = delete;    ///< owns the reserve, no copies
+    VMem &operator=(const VMem&) = delete;
+    bool grow(int n);   ///< commit at least n bytes, false (pmem full) if beyond reserve
+    bool full();        ///< report pmem full through stk_err
+
+    U8   &operator[](int i) INLINE { return i < 0 ? v[idx + i] : v[i]; }
+    U8   push(U8 t)         INLINE {
+        if (idx >= cap && !grow(idx + 1)) return t;
+        return v[max=idx++] = t;
+    }
+    void push(U8 *a, int n) INLINE {
+        if (idx + n > cap && !grow(idx + n)) return;
+        memcpy(v + idx, a, n); idx += n; max = idx - 1;
+    }
+    void clear(int i=0)     INLINE { idx=i; }
+};
+#endif // USE_IU32
+///
 ///@name Code flag masking options
 ///@{
 #define UDF_ATTR   0x0001   /** user defined word    */
 #define IMM_ATTR   0x0002   /** immediate word       */
-#define EXT_FLAG   0x8000   /** prim/xt/pfa selector */
-#if DO_WASM
-#define MSK_ATTR   ~0x0     /** no masking needed    */
-#else  // !DO_WASM
-#define MSK_ATTR   ~0x3     /** mask udf,imm bits    */
-#endif // DO_WASM
+#if USE_IU32
+#define EXT_FLAG   0x80000000u  /** prim/pfa selector     */
+#else  // !USE_IU32
+#define EXT_FLAG   0x8000   /** prim/pfa selector    */
+#endif // USE_IU32
 
-#define IS_UDF(w) (dict[w].attr & UDF_ATTR)
-#define IS_IMM(w) (dict[w].attr & IMM_ATTR)
+#if USE_DSOA
+#define IS_UDF(w) (VM_DATTR()[w] & UDF_ATTR)
+#define IS_IMM(w) (VM_DATTR()[w] & IMM_ATTR)
+#else  // !USE_DSOA
+#define IS_UDF(w) (VM_DICT()[w].attr & UDF_ATTR)
+#define IS_IMM(w) (VM_DICT()[w].attr & IMM_ATTR)
+#endif // USE_DSOA
 ///@}
 ///@name primitive opcode
 ///@{
 typedef enum {
     EXIT=0|EXT_FLAG, NOP, NEXT, LOOP, LIT, VAR, STR, DOTQ, BRAN, ZBRAN,
-    VBRAN, DOES, FOR, DO, KEY, MAX_OP
+    VBRAN, DOES, FOR, DO, KEY,
+    LADD, OVADD, RADD, DZBRAN, INEXT,   ///< fused: lit +, over +, r@ +, dup 0= 0bran, 1+ next
+    MAX_OP
 } prim_op;
 
+#if DO_WASM
+#define JSR_AREA   (ALIGN16(MAX_OP & ~EXT_FLAG))  /** JSB call records, after user vars */
+#define USER_AREA  (JSR_AREA + E4_JSR_SZ)
+#else  // !DO_WASM
 #define USER_AREA  (ALIGN16(MAX_OP & ~EXT_FLAG))
+#endif // DO_WASM
 #define IS_PRIM(w) ((w & EXT_FLAG) && (w < MAX_OP))
 ///@}
 ///
 ///> Universal functor (no STL) and Code class
-///  Code class on 64-bit systems (expand pfa possible)
-///  +-------------------+-------------------+
-///  |    *name          |       xt          |
-///  +-------------------+----+----+---------+
-///                      |attr|pfa |xxxxxxxxx|
-///                      +----+----+---------+
-///
-///  Code class on 32-bit systems (memory best utilized)
-///  +---------+---------+
-///  |  *name  |   xt    |
-///  +---------+----+----+
-///            |attr|pfa |
-///            +----+----+
-///
-///  Code class on WASM/32-bit (a bit wasteful)
-///  +---------+---------+----+----+
-///  |  *name  |   xt    |attr|pfa |
-///  +---------+---------+----+----+
+///  Code class, same on all targets (xt kept out of it, see XTAB)
+///  +-------------------+----+----+
+///  |    *name          |attr|pfa |
+///  +-------------------+----+----+
+///
+///  pfa is the pmem offset of a colon word, the XTAB index of a built-in
+///  or the opcode of a primitive, so a built-in token is a small index
+///  and no longer depends on where the compiler puts the lambdas
 ///
 typedef void (*FPTR)();     ///< function pointer
 struct Code {
-    static UFP XT0;         ///< function pointer base (in registers hopefully)
+    static FPTR XTAB[E4_DICT_SZ]; ///< built-in lambdas, by token
+    static IU   XTN;        ///< built-ins registered
     const char *name = 0;   ///< name field
-#if DO_WASM
-    FPTR xt   = 0;          ///< WASM fptr is just index to vtable
-    IU   attr = 0;          ///< So, attributes need to be separated
-    IU   pfa  = 0;          ///< i.e. no LSBs available
-#else // !DO_WASM
-    union {                 ///< either a primitive or colon word
-        FPTR xt = 0;        ///< lambda pointer (4-byte align, 2 LSBs can be used for attr)
-        struct {
-            IU attr;        ///< steal 2 LSBs because xt is 4-byte aligned on 32-bit CPU
-            IU pfa;         ///< offset to pmem space (16-bit for 64K range)
-        };
-    };
-#endif // DO_WASM
-    static FPTR XT(IU ix)   INLINE { return (FPTR)(XT0 + (UFP)(ix & MSK_ATTR)); }
-    static void exec(IU ix) INLINE { (*XT(ix))(); }
+    IU   attr = 0;          ///< UDF_ATTR, IMM_ATTR
+    IU   pfa  = 0;          ///< colon: pmem offset, built-in: XTAB index, prim: opcode
 
-    Code(const char *n, IU w) : name(n), xt((FPTR)((UFP)w)) {   ///< primitives
+    static FPTR XT(IU ix)   INLINE { return XTAB[ix]; }
+    static void exec(IU ix) INLINE { (*XTAB[ix])(); }
+
+    Code(const char *n, IU w) : name(n), pfa(w) {               ///< primitives
 #if CC_DEBUG > 1
-		LOG_KX("prim xt=", (UFP)xt); 
+		LOG_KX("prim op=", w);
 		LOG_KX(", nm=", (UFP)n); LOGS(" "); LOGS(n); LOGS("\n");
 #endif // CC_DEBUG > 1
     }
-    Code(const char *n, FPTR fp, bool im) : name(n), xt(fp) {
-        if ((UFP)xt < XT0) XT0 = (UFP)xt;                       ///> collect xt base
+    Code(const char *n, FPTR fp, bool im) : name(n), pfa(XTN) { ///< built-ins, forth_init only
+        if (XTN >= E4_DICT_SZ) throw "ERR: XTAB full";
+        XTAB[XTN++] = fp;                                       ///> register xt
         if (im) attr |= IMM_ATTR;
 #if CC_DEBUG > 1
-		LOG_KX("XT0=", XT0);  LOG_KX(" xt=", (UFP)xt); 
+		LOG_KX("xt=", (UFP)fp); LOG_KX(" ix=", pfa);
 		LOG_KX(", nm=", (UFP)n); LOGS(" "); LOGS(n); LOGS("\n");
 #endif // CC_DEBUG > 1
     }
     Code() {}               ///< create a blank struct (for initilization)
-    IU   xtoff() INLINE { return (IU)(((UFP)xt - XT0) & MSK_ATTR); }  ///< xt offset in code space
-    void call()  INLINE { (*(FPTR)((UFP)xt & MSK_ATTR))(); }
+    IU   xti()   INLINE { return pfa; }          ///< built-in token, i.e. XTAB index
+    void call()  INLINE { (*XTAB[pfa])(); }
 };
 ///
 ///> Add a Word to dictionary
@@ -135,27 +216,210 @@ struct Code {
 ///    a lambda without capture can degenerate into a function pointer
 #define ADD_CODE(n, g, im) {    \
     Code c(n, []{ g; }, im);	\
-    dict.push(c);               \
+    dict_add(c);                \
     }
 #define CODE(n, g) ADD_CODE(n, g, false)
 #define IMMD(n, g) ADD_CODE(n, g, true)
 ///
+///> Output buffer - fout writes straight into buf, which is passed to fout_cb
+///  in place (pointer, length, '\0' terminated) without copying
+/// Note:
+///    * flushed when full, at CR once E4_OUT_FLUSH bytes are pending,
+///      before blocking (delay, key), and when forth_vm returns
+///
+struct OutBuf : public streambuf {
+    char buf[E4_OUT_SZ + 1];            ///< +1 for '\0'
+    OutBuf() { setp(buf, buf + E4_OUT_SZ); }
+    int  len() { return (int)(pptr() - pbase()); }
+    void flush();                       ///< pass content to fout_cb, rewind
+protected:
+    int  overflow(int c) override;      ///< buffer full
+    int  sync() override;               ///< endl, i.e. CR
+};
+///
+///> Task - execution context, owns its stacks
+/// Note:
+///    * a VM is its own main task (driven by forth_vm)
+///    * spawned tasks share dictionary and pmem of their VM
+///      and run on a worker thread pool (see spawn, yield, join)
+///
+typedef enum { STOP=0, HOLD, QUERY, NEST, IO } vm_state;
+struct ForthVM;
+struct TraceRec {                       ///< one nest() step (see TRACE, vm_trace)
+    IU       ip;                        ///< opcode address
+    IU       op;                        ///< opcode
+    DU       top;                       ///< TOS before the op
+    S16      sdp;                       ///< ss depth
+    S16      rdp;                       ///< rs depth
+};
+struct Task {
+    Stack    _rs;                       ///< return stack
+    Stack    _ss;                       ///< parameter stack
+    IU       _ip      = 0;              ///< instruction pointer
+    vm_state _state   = QUERY;          ///< VM state
+    DU       _tos     = -DU1;           ///< top of stack (cached)
+    OutBuf   _obuf;                     ///< output buffer
+    ostream  _fout{&_obuf};             ///< forth_out
+    ForthVM  *_vm     = 0;              ///< VM this task belongs to
+#if DO_MULTITASK
+    IU       _xt      = 0;              ///< word to run, dict index
+    bool     _yld     = false;          ///< yield requested
+    atomic<bool> _done{false};          ///< finished, ready to join
+#endif // DO_MULTITASK
+#if DO_TRACE
+    TraceRec _tr[E4_TRACE_SZ];          ///< last nest() steps, written by this task only
+    U32      _tr_n    = 0;              ///< steps recorded, next slot is _tr_n % E4_TRACE_SZ
+    U32      _tr_ln   = 0;              ///< _tr_n when the current input line started
+#endif // DO_TRACE
+
+    Task(int ss = E4_SS_SZ, int rs = E4_RS_SZ) : _rs(rs), _ss(ss) {}
+};
+///
+///> VM context - one per Forth session
+/// Note:
+///    * built-in words are compiled once (by the first VM) and shared,
+///      each new VM gets a copy of their Code entries (name, xt pointers)
+///    * colon words, pmem, stacks and IO streams are private to a VM
+///
+#if DO_JIT
+struct JitEnt {                         ///< JIT table slot
+    IU       pfa;                       ///< colon word body
+    U16      n;                         ///< calls counted, ~0: never compile
+    U32      off;                       ///< code offset in _jbuf, 0: not compiled
+};
+#endif // DO_JIT
+#if DO_SCHECK
+struct SfxEnt {                         ///< stack effect of a colon word (see sfx_word)
+    IU       pfa;                       ///< colon word body, 0: empty slot
+    S8       lo, hi;                    ///< ss depth range, relative to entry
+    S8       rh;                        ///< rs depth high mark, relative to entry
+    S8       net;                       ///< ss depth change on exit
+};
+#endif // DO_SCHECK
+#if USE_DSOA
+struct DictKey {                        ///< packed name key, 8 to a cache line (see find)
+    U8       len;                       ///< name length, 255: longer
+    U8       h;                         ///< name hash, high byte
+    char     pfx[6];                    ///< leading chars, case-folded, 0 padded
+};
+#endif // USE_DSOA
+#if DO_WASM
+struct VMHdr {                          ///< VM state for JS views (see vm_hdr), all U32
+    U32      magic;                     ///< 'E4VM', little-endian
+    U32      seq;                       ///< odd: VM running, even: fields below valid
+    U32      ss_adr;                    ///< data stack base address
+    U32      ss_idx;                    ///< data stack depth, tos excluded
+    U32      tos_adr;                   ///< address of cached top of stack
+    U32      mem_adr;                   ///< parameter memory base address
+    U32      mem_idx;                   ///< HERE, offset into pmem
+    U32      radix;                     ///< numeric radix
+    U32      dfloat;                    ///< 1: float data unit
+    U32      dict_idx;                  ///< dictionary words
+    U32      frm_adr;                   ///< front frame buffer address, 0: none (see frames)
+    U32      frm_n;                     ///< slots in front frame buffer
+    U32      frm_seq;                   ///< frames published
+    U32      dict_gen;                  ///< bumped on any dictionary change (see vm_dict_pack)
+};
+struct DictHdr {                        ///< vm_dict_pack block header, records follow
+    U32      gen;                       ///< dictionary generation
+    U32      start;                     ///< index of first record, < from: words cut
+    U32      idx;                       ///< dictionary words
+    U32      n;                         ///< records in this block
+};
+#endif // DO_WASM
+struct ForthVM : Task {
+    List<Code, E4_DICT_SZ> _dict;       ///< dictionary
+#if USE_IU32
+    VMem                   _pmem;       ///< parameter memory, grows on demand
+#else  // !USE_IU32
+    List<U8,   E4_PMEM_SZ> _pmem;       ///< parameter memory (for colon definitions)
+#endif // USE_IU32
+    IU       _hbkt[E4_HASH_SZ] = {};    ///< dict hash bucket heads
+    IU       _hnxt[E4_DICT_SZ] = {};    ///< dict hash chains
+    IU       _dref[E4_DICT_SZ] = {};    ///< pfa|EXT_FLAG of colon words, token of built-ins, always kept
+    IU       _rbkt[E4_HASH_SZ] = {};    ///< dref hash bucket heads (see pfa2didx)
+    IU       _rnxt[E4_DICT_SZ] = {};    ///< dref hash chains
+#if USE_DSOA
+    DictKey  _dkey[E4_DICT_SZ]  = {};   ///< dict name keys, checked before the name (see find)
+    IU       _dpfa[E4_DICT_SZ]  = {};   ///< dict[i].pfa, read by CALL and add_w
+    U8       _dattr[E4_DICT_SZ] = {};   ///< dict[i].attr, read by IS_UDF, IS_IMM
+#endif // USE_DSOA
+    bool     _compile = false;          ///< compiler flag
+    bool     _upper   = false;          ///< case sensitivity control
+    IU       _load_dp = 0;              ///< depth of recursive include
+    IU       *_base   = 0;              ///< numeric radix (a pointer)
+    IU       *_dflt   = 0;              ///< use float data unit flag
+    const char    *_tin  = 0;           ///< input, parsed in place
+    const char    *_tend = 0;           ///< end of input
+    string        _tkeep;               ///< unparsed input kept across yield
+    bool          _kept  = false;       ///< _tin points into _tkeep
+    char          _tok[E4_TOK_SZ];      ///< '\0' terminated token (see word)
+    string        _pad;                 ///< string buffer (JS interface)
+    void (*_fout_cb)(int, const char*) = 0;  ///< output callback (see ENDL macro)
+#if DO_MULTITASK
+    Task     *_task[E4_TASK_SZ] = {};   ///< spawned tasks, slot+1 is task id
+    mutex    _tmx;                      ///< task table lock
+    mutex    _omx;                      ///< output callback lock
+#endif // DO_MULTITASK
+#if DO_SCHECK
+    SfxEnt   _sfx[E4_SFX_TAB] = {};     ///< known stack effects, direct mapped by pfa
+#endif // DO_SCHECK
+#if DO_WASM
+    VMHdr    _hdr     = {};             ///< refreshed on each return to JS
+    U8       _wait    = 0;              ///< suspended on, see vm_wait_t
+    long     _wt      = 0;              ///< time of last run, for WAIT_JS slicing
+    int      _jsr_n   = 0;              ///< JSB record bytes pending (see native_bin)
+    bool     _jsr_b   = false;          ///< in JS[ ... ]JS, send at ]JS
+    IU       _frm     = 0;              ///< frame buffers in pmem, 0: none (see frames)
+    IU       _frm_sz  = 0;              ///< slots per buffer
+    U8       _frm_b   = 0;              ///< back buffer, the one Forth writes
+    IU       _frm_n   = 0;              ///< slots in front buffer
+    U32      _frm_seq = 0;              ///< frames published
+    U32      _dgen    = 0;              ///< dictionary generation
+    IU       _dcut    = 0;              ///< lowest word changed since last vm_dict_pack
+#endif // DO_WASM
+#if DO_DIRTY
+    U8       _dmap[E4_PMEM_SZ >> 7] = {};  ///< written 16-byte pmem lines, a bit each
+    IU       _dlo     = 0;              ///< lowest HERE since last vm_dirty
+#endif // DO_DIRTY
+#if DO_JIT
+    U8       *_jbuf   = 0;              ///< JIT code buffer, mapped on first use
+    int      _jhere   = 0;              ///< JIT code bytes used, -1: no exec memory
+    int      _jdepth  = 0;              ///< JIT code frames on the C stack
+    bool     _jstale  = false;          ///< flushed while running, reuse when idle
+    JitEnt   _jtab[E4_JIT_TAB] = {};    ///< JIT table, direct mapped by pfa
+#endif // DO_JIT
+
+    ForthVM(int ss = E4_SS_SZ, int rs = E4_RS_SZ) : Task(ss, rs) { _vm = this; }
+};
+///
 ///> System interface
 ///
-void forth_init();
-int  forth_vm(const char *cmd, void(*hook)(int, const char*)=NULL);
+ForthVM *forth_init();                    ///< create first VM, compile built-ins
+ForthVM *forth_new(int ss_sz = E4_SS_SZ, int rs_sz = E4_RS_SZ); ///< create another VM, built-ins shared
+void forth_free(ForthVM *vm);             ///< release a VM created by forth_new
+int  forth_vm(const char *cmd, void(*hook)(int, const char*)=NULL, ForthVM *vm=NULL);
 int  forth_include(const char *fn);       /// load external Forth script
 void outer(istream &in);                  ///< Forth outer loop
+void outer(const char *buf, int n);       ///< Forth outer loop, lines parsed in place
+void include_buf(const char *src, int n); ///< run a loaded script (see forth_include)
+int  forth_image_save(U8 *buf, int max);  ///< snapshot size, 0 if max too small, buf=NULL for size
+int  forth_image_load(const U8 *buf, int n); ///< 1: restored, 0: not an image of this build
+int  forth_image_file(const char *fn, bool save); ///< native save-image/load-image
 ///
 ///> IO functions
 ///
 typedef enum { BASE=0, BL, CR, DOT, DOTR, EMIT, SPCS } io_op;
 void key();                               ///< read key from console
-void fin_setup(const char *line);
+struct Str { const char *s; int n; };    ///< view into input, not '\0' terminated
+void fin_setup(const char *line, int n);
+void fin_keep();                          ///< own unparsed input before yielding
 void fout_setup(void (*hook)(int, const char*)=NULL);
+void fout_flush();                        ///< send pending output to fout_cb
 
-char *scan(char c);                       ///< scan input stream for a given char
-int  fetch(string &idiom);                ///< read input stream into string
+char *ntoa(char *buf, DU v, int b);       ///< number to string in radix b, buf[E4_NBUF]
+Str  scan(char c);                        ///< scan input up to a given char
+int  fetch(Str &t);                       ///< next blank delimited token
 void spaces(int n);                       ///< show spaces
 void put(io_op op, DU v=DU0, DU v2=DU0);  ///< print literals
 void pstr(const char *str, io_op op=BL);  ///< print string
@@ -168,9 +432,18 @@ void ss_dump(bool forced=false);          ///< show data stack content
 void dict_dump();                         ///< dump dictionary
 void mem_dump(U32 addr, IU sz);           ///< dump memory frm addr...addr+sz
 void mem_stat();                          ///< display memory statistics
+void prof_dump();                         ///< display profiler report
+void trace_dump(int n, bool line=false);  ///< display last n nest() steps, line: of this input line only
 ///
 ///> Javascript interface
 ///
 void native_api();
+void native_bin();                        ///< JSB, binary call record
+void js_flush(bool done);                 ///< send pending JSB records
+U8   *frame_buf(bool back);               ///< frame buffer, 0 if none (see frames)
+#if DO_WASM
+typedef enum { WAIT_NONE=0, WAIT_KEY, WAIT_MS, WAIT_LOAD, WAIT_JS } vm_wait_t;
+int  vm_wait(vm_wait_t w, U32 arg=0, const char *fn=0); ///< 1: suspended, JS resumes it (vm_wake)
+#endif // DO_WASM
 ///
 #endif // __EFORTH_SRC_CEFORTH_H
@@ -7,32 +7,94 @@
 /// Benchmark: 10K*10K cycles on desktop (3.2G AMD)
 ///    RANGE_CHECK     0 cut 100ms
 ///    INLINE            cut 545ms
+///    USE_CGOTO       1 cut ~10% where built-ins dispatch (native only, WASM stays with switch)
 ///
 ///@name Conditional compililation options
 ///@}
 #define APP_VERSION     "weForth v4.2"
 #define CC_DEBUG        1               /**< debug level 0|1|2      */
 #define RANGE_CHECK     0               /**< vector range check     */
+#define USE_SCHECK      1               /**< stack effect at ;, depth checks in nest() */
+#define DO_SCHECK       (USE_SCHECK && !RANGE_CHECK) /**< RANGE_CHECK checks every push/pop */
 #define USE_FLOAT       1               /**< support floating point */
+#define DO_FUSE         1               /**< superinstruction fusion at ; */
+#define USE_INLINE      1               /**< tail calls, inline short colon words at compile */
+#define DO_INLINE       (USE_INLINE && DO_FUSE) /**< shares the fusion pass */
+#define USE_DSOA        0               /**< packed name keys, pfa and attr arrays beside dict */
+#define DO_PROFILE      0               /**< per-word profiler      */
+#define DO_TRACE        0               /**< nest() steps into a ring per task, see .trace */
+#ifndef DO_MAIN
+#define DO_MAIN         1               /**< 0: VM linked into a host, i.e. tests/bench */
+#endif // DO_MAIN
 #define DO_WASM         __EMSCRIPTEN__  /**< for WASM output        */
+#define USE_DIRTY       1               /**< track written pmem lines for the web memory view */
+#define DO_DIRTY        (USE_DIRTY && DO_WASM) /**< see vm_dirty */
+#define USE_CGOTO       1               /**< computed goto nest()   */
+#define DO_CGOTO        (USE_CGOTO && !DO_WASM && __GNUC__) /**< native GCC/Clang only */
+#ifndef USE_IU32
+#define USE_IU32        0               /**< 32-bit IU and growable pmem, 0: 16-bit for MCU */
+#endif // USE_IU32
+#define USE_LREG        1               /**< nest() keeps IP, tos, stack tops in locals */
+#define DO_LREG         (USE_LREG && !DO_PROFILE && !RANGE_CHECK) /**< profiler needs rs.idx live */
+#define USE_CALIGN      1               /**< cells on 4-byte boundaries, 0: packed 2-byte */
+#define USE_STKGUARD    1               /**< stack overflow caught without RANGE_CHECK, see Stack */
+#define DO_STKPAGE      (USE_STKGUARD && !DO_WASM && !(ARDUINO || ESP32) && !(_WIN32 || _WIN64)) /**< POSIX guard pages */
+#define DO_STKPAD       (USE_STKGUARD && !DO_STKPAGE) /**< sentinel cells, checked where nest() yields */
+#define USE_SIMD        1               /**< 4-lane vector words (v+ v* vdot ...) */
+#define DO_SIMD         (USE_SIMD && __GNUC__ && !(ARDUINO || ESP32)) /**< SSE/NEON/SIMD128 */
+#define USE_JIT         1               /**< hot colon words to native code */
+#define DO_JIT          (USE_JIT && __x86_64__ && !DO_WASM && !(_WIN32 || _WIN64) && !DO_PROFILE && !DO_TRACE && !RANGE_CHECK) /**< x86-64 SysV only */
+#define USE_MULTITASK   1               /**< spawn/yield/join tasks on a thread pool */
+#define DO_MULTITASK    (USE_MULTITASK && !DO_WASM && !(ARDUINO || ESP32)) /**< native only */
 ///@}
 ///@name Memory block configuation
 ///@{
-#define E4_RS_SZ        32
-#define E4_SS_SZ        32
+#define E4_RS_SZ        32              /**< default, per VM see forth_new and stacks */
+#define E4_SS_SZ        32              /**< default, per VM see forth_new and stacks */
+#define E4_STK_PAD      4               /**< sentinel cells on each end of a stack (DO_STKPAD) */
 #define E4_DICT_SZ      400
+#define E4_SFX_TAB      512             /**< stack effect slots by pfa, power of 2 */
+#define E4_SFX_MARGIN   4               /**< stack cells kept free for a checked op */
+#define E4_HASH_SZ      256             /**< dict hash buckets, power of 2 */
+#if USE_IU32
+#define E4_PMEM_SZ      (USE_FLOAT ? 16*1024*1024 : 256*1024*1024) /**< reserved, float DU addresses exact to 16M */
+#define E4_PMEM_STEP    (64*1024)       /**< pmem commit granularity       */
+#else  // !USE_IU32
 #define E4_PMEM_SZ      (32*1024)
+#endif // USE_IU32
+#define E4_OUT_SZ       4096            /**< output buffer per task        */
+#define E4_OUT_FLUSH    1024            /**< CR flushes above this, 0: every CR */
+#define E4_NBUF         48              /**< number formatting buffer      */
+#define E4_INLINE       (8*sizeof(IU))  /**< max body bytes of an inlined word */
+#define E4_JIT_HOT      32              /**< colon calls before a word is JIT compiled */
+#define E4_JIT_SZ       (256*1024)      /**< JIT code buffer per VM        */
+#define E4_JIT_TAB      256             /**< JIT pfa => code slots, power of 2 */
+#define E4_TOK_SZ       64              /**< max token length, see word()  */
+#define E4_JSR_SZ       1024            /**< WASM JSB call record area in pmem, see native_bin */
+#define E4_FRM_SLOT     8               /**< frame slot cells: id x y z qx qy qz qw */
+#define E4_TRACE_SZ     256             /**< trace ring records, power of 2 (DO_TRACE) */
+#define E4_TRACE_DUMP   8               /**< records shown on a stack error */
+#define E4_TASK_SZ      64              /**< max live tasks per VM         */
+#define E4_NTHREAD      0               /**< worker threads, 0: one per core */
+#define E4_SLICE        10              /**< task time slice in ms         */
 ///@}
 ///
 ///@name Logical units (instead of physical) for type check and portability
 ///@{
+typedef uint64_t        U64;   ///< unsigned 64-bit integer
 typedef uint32_t        U32;   ///< unsigned 32-bit integer
 typedef int32_t         S32;   ///< signed 32-bit integer
 typedef uint16_t        U16;   ///< unsigned 16-bit integer
+typedef int16_t         S16;   ///< signed 16-bit integer
+typedef int8_t          S8;    ///< signed 8-bit integer
 typedef uint8_t         U8;    ///< byte, unsigned character
 
 typedef uintptr_t       UFP;   ///< function pointer as integer
+#if USE_IU32
+typedef uint32_t        IU;    ///< instruction pointer unit
+#else  // !USE_IU32
 typedef uint16_t        IU;    ///< instruction pointer unit
+#endif // USE_IU32
 
 #if USE_FLOAT
 #include <cmath>
@@ -74,7 +136,11 @@ typedef int32_t         DU;
 #define ALIGN4(sz)      ((sz) + (-(sz) & 0x3))
 #define ALIGN16(sz)     ((sz) + (-(sz) & 0xf))
 #define ALIGN32(sz)     ((sz) + (-(sz) & 0x1f))
+#if USE_IU32
+#define ALIGN(sz)       ALIGN4(sz)      /**< keep 32-bit IU fetches aligned */
+#else  // !USE_IU32
 #define ALIGN(sz)       ALIGN2(sz)
+#endif // USE_IU32
 #define STRLEN(s)       (ALIGN(strlen(s)+1))  /** calculate string size with alignment */
 ///@}
 ///@name Multi-platform support
@@ -82,12 +148,13 @@ typedef int32_t         DU;
 #if    _WIN32 || _WIN64
     #define ENDL "\r\n"
 #else  // !(_WIN32 || _WIN64)
-    #define ENDL endl; fout_cb(fout.str().length(), fout.str().c_str()); fout.str("")
+    #define ENDL endl               /**< flush decided by OutBuf::sync */
 #endif // _WIN32 || _WIN64
 
 #if (ARDUINO || ESP32)
     #include <Arduino.h>
-    #define DALIGN(sz)      (sz)
+    #define DALIGN(sz)      (USE_CALIGN ? ALIGN4(sz) : (sz))
+    #define nanos()         ((U64)micros() * 1000)
     #define to_string(i)    string(String(i).c_str())
     #if    ESP32
         #define analogWrite(c,v,mx) ledcWrite((c),(8191/mx)*min((int)(v),mx))
@@ -97,7 +164,8 @@ typedef int32_t         DU;
     #include <emscripten.h>
     #define DALIGN(sz)      ALIGN4(sz)
     #define millis()        EM_ASM_INT({ return Date.now(); })
-    #define delay(ms)       EM_ASM({                                      \
+    #define nanos()         ((U64)(emscripten_get_now() * 1000000.0))
+    #define delay(ms)       EM_ASM({    /* blocking, unless vm_wait */ \
                                 const xhr = new XMLHttpRequest();         \
                                 xhr.timeout = 1.1*$0;                     \
                                 xhr.open('GET', "/SLEEP?t="+$0, false);   \
@@ -121,9 +189,11 @@ typedef int32_t         DU;
 #else  // !(ARDUINO || ESP32) && !DO_WASM
     #include <chrono>
     #include <thread>
-    #define DALIGN(sz)      (sz)
+    #define DALIGN(sz)      (USE_CALIGN ? ALIGN4(sz) : (sz))
     #define millis()        chrono::duration_cast<chrono::milliseconds>( \
                             chrono::steady_clock::now().time_since_epoch()).count()
+    #define nanos()         ((U64)chrono::duration_cast<chrono::nanoseconds>( \
+                            chrono::steady_clock::now().time_since_epoch()).count())
     #define delay(ms)       this_thread::sleep_for(chrono::milliseconds(ms))
     #define yield()         this_thread::yield()
     #define PROGMEM
@@ -147,7 +217,7 @@ typedef int32_t         DU;
 #define LOG_KX(k, x)    LOGS(k); LOGX(x)
 #define LOG_HDR(f, s)   LOGS(f); LOGS("("); LOGS(s); LOGS(") => ")
 #define LOG_DIC(i)      LOGS("dict["); LOG(i); LOGS("] ");  \
-                        LOGS(dict[i].name); LOGS(" attr="); \
-                        LOGX(dict[i].attr); LOGS("\n")
+                        LOGS(VM_DICT()[i].name); LOGS(" attr="); \
+                        LOGX(VM_DICT()[i].attr); LOGS("\n")
 ///@}
 #endif // __EFORTH_SRC_CONFIG_H
@@ -274,6 +274,15 @@ export default class {
         
         this.intf.ActivateBody(bid)
     }
+    setTransform(id, pos, rot) {             // move a body, e.g. from a Forth frame
+        const msh = this.ospace[id]
+        if (msh) {
+            this.intf.SetPositionAndRotation(
+                msh.userData.body.GetID(), pos, rot, Jolt.EActivation_Activate)
+        }
+        Jolt.destroy(pos)
+        Jolt.destroy(rot)
+    }
     tick(id, on=true) {                      // reactivate a body
         let bid = this.ospace[id].userData.body.GetID()
         if (on) this.intf.ActivateBody(bid)
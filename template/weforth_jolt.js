@@ -228,15 +228,27 @@ function jolt_req(req) {                    ///> jolt job queue
     req_q.push(req)
     return 1
 }
+let frm_q = null                            ///< latest frame from worker, not yet applied
+function jolt_frame(f) { frm_q = f }        ///> see frames/frame-swap, vm_frame
+function frm_apply(core) {                  ///> [id x y z qx qy qz qw] per slot
+    const f = frm_q
+    frm_q = null
+    for (let i = 0; i + 8 <= f.length; i += 8) {
+        core.setTransform(
+            f[i]|0,
+            new Jolt.RVec3(f[i+1], f[i+2], f[i+3]),
+            new Jolt.Quat(f[i+4], f[i+5], f[i+6], f[i+7]))
+    }
+}
 function jolt_update(core) {
     if (xkey.callback) xkey.callback(core)
     veh_update()
+    if (frm_q) frm_apply(core)              /// * one frame per physics step
     
     const v = req_q.shift()                 ///> pop from command request queue
     if (!v) return                          /// * queue empty, bail
 
     v.push(Date.now() - v[0])               /// * encode timediff
-    console.log(v)                          /// * debug trace
     
     const cmd  = v[1]                       ///> Jolt command
     const n    = v[2]|0                     ///> object_id (integer)
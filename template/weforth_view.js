@@ -0,0 +1,107 @@
+///
+/// @file
+/// @brief weForth - VM state views over WASM memory (see VMHdr in ceforth.h)
+///
+/// @note: used by weforth_worker.js on its own WASM memory, and by
+///        weforth.html directly when the memory is a SharedArrayBuffer
+///        (i.e. cross-origin isolated, built with 'make coi')
+///
+const VM_HDR = [                               ///< VMHdr fields, U32 each
+    'magic',   'seq',     'ss_adr', 'ss_idx', 'tos_adr',
+    'mem_adr', 'mem_idx', 'radix',  'dfloat', 'dict_idx',
+    'frm_adr', 'frm_n',   'frm_seq', 'dict_gen' ]
+const FRM_SLOT = 8                             ///< id x y z qx qy qz qw, E4_FRM_SLOT
+
+function vm_hdr(buf, adr) {                    ///> read header into an object
+    const u = new Uint32Array(buf, adr, VM_HDR.length)
+    let   h = {}
+    VM_HDR.forEach((k, i)=>h[k] = u[i])
+    return h
+}
+function vm_ss(buf, h) {                       ///> data stack as a string
+    const FX = v=>Number.isInteger(v)          ///> precision control macro
+          ? v.toString(h.radix)
+          : Math.round(v*100000)/100000        /// * better than toFixed()
+    const toa = (p, n)=> h.dfloat
+        ? new Float32Array(buf, p, n)
+        : (h.radix==10
+           ? new Int32Array(buf, p, n)
+           : new Uint32Array(buf, p, n))
+    const len = (h.ss_idx|0) > 0 ? h.ss_idx : 0  /// * U32, may wrap on underflow
+    const ss  = toa(h.ss_adr, len)
+    const tos = toa(h.tos_adr, 1)
+    let   div = []
+    ss.forEach(v=>div.push(FX(v)))
+    div.push(FX(tos[0]))
+
+    return '[ '+div.join(' ')+' ]'
+}
+function vm_mem(buf, h, off, len) {            ///> pmem block, no copy
+    return new Uint8Array(buf, h.mem_adr + off, len)
+}
+const hx = '0123456789ABCDEF'
+function dump_line(off, b, b0) {               ///> one 16-byte line, b0: bytes before
+    const h2 = v=>hx[(v>>4)&0xf]+hx[v&0xf]
+    const h4 = v=>h2(v>>8)+h2(v)
+    let bt = '', tx = '', en = 0
+    for (let i = 0; i < 0x10; i++) {
+        let c0 = b0[i] || 0
+        let c  = b[i]  || 0
+        if (!en && c != c0) {
+            bt += '<i>'; tx += '<i>'; en = 1            /// * enter i element
+        }
+        else if (en && c == c0) {
+            bt += '</i>'; tx += '</i>'; en = 0          /// * exit <i> element
+        }
+        bt += `${hx[c>>4]}${hx[c&0xf]}`
+        bt += ((i & 0x3)==3) ? '  ' : ' '
+        tx += (c < 0x20) ? '_' : String.fromCharCode(c)
+    }
+    if (en) { bt += '</i>'; tx += '</i>' }
+    return h4(off) + ': ' + bt + tx + '\n'
+}
+let dump_mem0 = ''                                      /// memory cache
+function dump(mem, off) {
+    if (dump_mem0.length != mem.length) {               /// check buffer size
+        dump_mem0 = new Uint8Array(mem.length)          /// free and realloc
+    }
+    let div = ''
+    for (let j = 0; j < mem.length; j+=0x10) {
+        const b = mem.slice(j, j + 0x10)
+        div += dump_line(off + j, b, dump_mem0.subarray(j, j + 0x10))
+        dump_mem0.set(b, j)                             /// * cache the chars
+    }
+    return div
+}
+function dump_win(h, idx, n) {                 ///> [ offset, length ] of a dump
+    const len = (n + 0x10) & ~0xf              ///> 16-byte blocks
+    const off = idx < 0
+        ? (h.mem_idx > len ? h.mem_idx - len : 0)
+        : idx
+    return [ off, len ]
+}
+function vm_dump(buf, h, idx, n) {             ///> dump n bytes, idx < 0 => from HERE
+    const [ off, len ] = dump_win(h, idx, n)
+    return dump(vm_mem(buf, h, off & ~0xf, len), off)
+}
+let dump_ln = new Map()                        ///< line cache, offset => { b, s, hl }
+function vm_dump_dirty(buf, h, off, len, dl) { ///> as vm_dump, read only lines in dl
+    const d = dl ? new Set(dl) : null          /// * null: not tracked, read all
+    const a0 = off & ~0xf
+    if (dump_ln.size > 0x1000) dump_ln.clear() /// * window moved a lot
+    let div = ''
+    for (let a = a0; a < a0 + len; a += 0x10) {
+        let e = dump_ln.get(a)
+        if (!e || !d || d.has(a)) {            /// * new or written, from WASM memory
+            const b = vm_mem(buf, h, a, 0x10).slice()
+            e = { b: b, s: dump_line(a, b, e ? e.b : b), hl: !!e }
+            dump_ln.set(a, e)
+        }
+        else if (e.hl) {                       /// * unchanged, drop last highlight
+            e.s  = dump_line(a, e.b, e.b)
+            e.hl = false
+        }
+        div += e.s
+    }
+    return div
+}
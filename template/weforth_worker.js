@@ -2,96 +2,110 @@
 /// @file
 /// @brief weForth - worker proxy to weforth.js (called by weforth.html)
 ///
-Module = { print: s=>postMessage(['txt', s]) } ///> WASM print interface => output queue
+Module = {
+    print:   s=>vm_post(['txt', s]),          ///> WASM print interface => output queue
+    postRun: [ vm_share ]                     ///> after main(), VM ready
+}
 
-var vm_dict_len = 0
+var vm_words    = []                           ///< dictionary cache [name, flags, pfa]
+var vm_wgen     = -1                           ///< its generation, see vm_dict_pack
+var vm_dgen     = { dc: -1, usr: -1 }          ///< generation each view was built from
 var vm_boot_idx = 0
+var vm_batch    = null                         ///< responses held for a 'bat' request
+var vm_xfer     = []                           ///< and their transferables
+///
+/// post to front-end, or hold until the batch is done
+/// @note: also called by key() and js_call() in ceforth.cpp
+///
+function vm_post(msg, xfer=[]) {
+    if (!vm_batch) { postMessage(msg, xfer); return }
+    vm_batch.push(msg)
+    vm_xfer.push(...xfer)
+}
+
+///
+/// hand WASM memory to front-end when it is shared (make coi, COOP/COEP served)
+/// so stack and memory views are read in place, see weforth_view.js
+///
+function vm_share() {
+    const m = wasmExports.memory
+    if (!self.crossOriginIsolated ||
+        !(m.buffer instanceof SharedArrayBuffer)) return
+    postMessage([ 'sab', [ m, wasmExports.vm_hdr(0) ] ])
+}
 
 importScripts('weforth_helper.js')             ///> vocabulary handler
+importScripts('weforth_view.js')               ///> stack and memory views
 importScripts('weforth.js')                    ///> load js emscripten created
 
-function get_ss() {
-    const FX = v=>Number.isInteger(v)          ///> precision control macro
-          ? v.toString(base)
-          : Math.round(v*100000)/100000        /// * better than toFixed()
-    const wa  = wasmExports
-    const base= wa.vm_base()
-    const toa = (p, n)=> wa.vm_dflt()
-        ? new Float32Array(wa.memory.buffer, p, n)
-        : (base==10
-           ? new Int32Array(wa.memory.buffer, p, n)
-           : new Uint32Array(wa.memory.buffer, p, n))
-    const len = wa.vm_ss_idx()>0 ? wa.vm_ss_idx() : 0
-    const ss  = toa(wa.vm_ss(), len)
-    const tos = toa(wa.tos, 1)
-    let   div = []
-    ss.forEach(v=>div.push(FX(v)))
-    div.push(FX(tos[0]))
-
-    return '[ '+div.join(' ')+' ]'
+const vm_buf = ()=>wasmExports.memory.buffer        ///< current, may grow
+const vm_h   = ()=>vm_hdr(vm_buf(), wasmExports.vm_hdr(0))
+function get_ss() { return vm_ss(vm_buf(), vm_h()) }
+const DICT_HDR = 16                                    ///< DictHdr, 4 x U32
+function dict_sync() {                                 ///> fetch words changed since last
+    if (vm_h().dict_gen == vm_wgen) return
+    const sz = 0x4000, p = Module._malloc(sz), td = new TextDecoder()
+    for (;;) {                                         /// * more blocks, if buf too small
+        const n  = wasmExports.vm_dict_pack(0, vm_words.length, p, sz)
+        const dv = new DataView(vm_buf(), p, n)
+        const [ gen, start, idx, k ] = [0, 4, 8, 12].map(i=>dv.getUint32(i, true))
+        vm_words.length = start                        /// * cut by forget, boot or is
+        let   o = DICT_HDR
+        for (let i = 0; i < k; i++) {
+            const pfa = dv.getUint32(o, true), f = dv.getUint8(o+4), len = dv.getUint8(o+5)
+            const nm  = td.decode(new Uint8Array(dv.buffer, p + o + 6, len).slice())
+            if (nm=='boot') vm_boot_idx = start + i + 1 ///< capture the start of colon words
+            vm_words.push([ nm, f, pfa ])
+            o += 6 + len
+        }
+        vm_wgen = gen
+        if (!k || vm_words.length >= idx) break
+    }
+    Module._free(p)
 }
 function get_dict(usr=false) {
-    const wa  = wasmExports
-    const len = wa.vm_dict_idx()
-    if (vm_dict_len == len) return ''     /// * dict no change, use cached
-    
-    vm_dict_len = len
-    const dict = Module.cwrap('vm_dict', 'string', ['number'])
-    let lst = []                          ///< built-in words list
-    for (let i = usr ? vm_boot_idx : 0; i < len; ++i) {
-        let nm = dict(i)
-        if (nm=='boot') vm_boot_idx = i+1 ///< capture the start of colon words
-        if (nm[0] != '_') lst.push(nm)    ///< collect words
+    dict_sync()
+    const k = usr ? 'usr' : 'dc'
+    if (vm_dgen[k] == vm_wgen) return undefined        /// * no change, page keeps its copy
+    vm_dgen[k] = vm_wgen
+    let lst = []                                       ///< words list
+    for (let i = usr ? vm_boot_idx : 0; i < vm_words.length; ++i) {
+        const nm = vm_words[i][0]
+        if (nm[0] != '_') lst.push(nm)                 ///< collect words
     }
     return usr ? colon_words(lst) : voc_tree(lst)
 }
 function get_mem(off, len) {
-    const wa  = wasmExports
-    const adr = wa.vm_mem() + off
-    return new Uint8Array(wa.memory.buffer, adr, len)   /// CC: freed by caller?
+    return vm_mem(vm_buf(), vm_h(), off, len)          /// CC: freed by caller?
 }
-
-let dump_mem0 = ''                                      /// memory cache
-function dump(mem, off) {
-    const hx  = '0123456789ABCDEF'
-    const h2  = v=>hx[(v>>4)&0xf]+hx[v&0xf]
-    const h4  = v=>h2(v>>8)+h2(v)
-    if (dump_mem0.length != mem.length) {               /// check buffer size
-        dump_mem0 = new Uint8Array(mem.length)          /// free and realloc
+let vm_dl = { p: 0, n: 0 }                              ///< vm_dirty line buffer
+function get_dirty(off, len) {                         ///> lines written, null: not tracked
+    const n = (len >> 4) + 1
+    if (n > vm_dl.n) {
+        Module._free(vm_dl.p)
+        vm_dl = { p: Module._malloc(n * 4), n: n }
     }
-    let div = ''
-    for (let j = 0; j < mem.length; j+=0x10) {
-        let bt = '', tx = '', en = 0
-        for (let i = 0; i < 0x10; i++) {
-            let c0 = dump_mem0[j + i] || 0
-            let c  = dump_mem0[j + i] = mem[j + i] || 0 ///> also cache the char
-            if (!en && c != c0) {
-                bt += '<i>'; tx += '<i>'; en = 1        /// * enter i element
-            }
-            else if (en && c == c0) {
-                bt += '</i>'; tx += '</i>'; en = 0      /// * exit <i> element
-            }
-            bt += `${hx[c>>4]}${hx[c&0xf]}`
-            bt += ((i & 0x3)==3) ? '  ' : ' '
-            tx += (c < 0x20) ? '_' : String.fromCharCode(c)
-        }
-        if (en) { bt += '</i>'; tx += '</i>' }
-        div += h4(off+j) + ': ' + bt + tx + '\n'
-    }
-    return div
+    const k = wasmExports.vm_dirty(0, off, len, vm_dl.p, n)
+    return k < 0 ? null : new Uint32Array(vm_buf(), vm_dl.p, k)
+}
+function get_dump(idx, n) {                            ///> redraw written lines only
+    const h = vm_h(), [ off, len ] = dump_win(h, idx, n)
+    return vm_dump_dirty(vm_buf(), h, off, len, get_dirty(off, len))
 }
 function get_px(v) {
-    console.log(v)
     const op = v[0], fg = v[1]|0  ///> opcode, foreground-color
     const px = v[2]|0             ///> offsets to geometry buffer
     const ps = v[3]|0             ///> offset to shape buffer
     const wa = wasmExports
-    const mem= wa.vm_mem()
+    const mem= wa.vm_mem(0)
     ///
     /// references to WASM ArrayBuffer without copying (fast, < 1ms)
     ///
     const x0 = new Float32Array(wa.memory.buffer, mem+px, 3)  ///> x1, x2, x3
     const s0 = new Float32Array(wa.memory.buffer, mem+ps, 8)  ///> id, pos, rot
+    if (x0.buffer instanceof SharedArrayBuffer) {   /// * front-end reads in place
+        return [ op, fg, x0, s0, v[4], Date.now()-v[4] ]
+    }
     ///
     /// convert to transferable objects (F64 takes 2ms, F32 5ms)
     ///
@@ -105,35 +119,125 @@ function get_px(v) {
 /// @note: serialization, i.e. structuredClone(), is slow (24ms)
 ///        so prebuild a transferable object is much faster (~5ms)
 ///
-const forth = Module.cwrap('forth', 'int', ['number', 'string'])
-self.onmessage = function(e) {                        ///> worker input message queue
-    let k = e.data[0], v = e.data[1]
-    const post = (v)=>postMessage([k, v])             ///> macro to response to front-end
+/// @note: 'bat' carries a list of [k, v] requests, one forth_vm() each,
+///        output, key mode, stack and dictionary replies come back in
+///        a single ['bat', [[k, v], ...]] message, in request order
+///
+const forth = Module.cwrap('forth', 'int', ['number', 'number', 'string'])
+///
+/// VM suspension, see vm_wait() in ceforth.cpp
+///
+/// @note: KEY, delay, included and JS hand the worker back to its event
+///        loop instead of blocking it (no sync XHR to /SLEEP), the VM is
+///        picked up by vm_wake() later, so many timed loops (one VM each,
+///        see vm_create) share this one thread; the 'cmd' reply of the
+///        main VM (h=0) is posted when it is finally done
+///
+const WAIT_KEY = 1, WAIT_MS = 2, WAIT_LOAD = 3, WAIT_JS = 4 ///< vm_wait_t
+const vm_susp  = new Set()                    ///< suspended VM handles
+const vm_pend  = []                           ///< 'cmd' held while main VM suspended
+const vm_tick  = new MessageChannel()         ///< zero-delay macrotask, no 4ms clamp
+const vm_tickq = []
+vm_tick.port1.onmessage = ()=>vm_tickq.shift()()
+const vm_later = (f)=>{ vm_tickq.push(f); vm_tick.port2.postMessage(0) }
+
+function vm_suspend(h, w, arg, fn) {          ///> called by vm_wait(), must not block
+    switch (w) {
+    case WAIT_KEY : vm_post(['key', 1]);                break   /// * 'key' request wakes
+    case WAIT_MS  : setTimeout(()=>vm_wake(h, 0), arg); break
+    case WAIT_LOAD:
+        fetch(fn)
+            .then(r=>r.ok ? r.text() : null)
+            .catch(()=>null)
+            .then(s=>vm_wake(h, s==null ? 0 : vm_str(s)));   break
+    case WAIT_JS  : vm_later(()=>vm_wake(h, 0));       break   /// * let messages through
+    default: return 0                                          /// * VM blocks instead
+    }
+    vm_susp.add(h)
+    return 1
+}
+function vm_str(s) {                          ///> script into WASM heap, freed by vm_wake
+    const b = new TextEncoder().encode(s)
+    const p = Module._malloc(b.length + 1)
+    const m = new Uint8Array(wasmExports.memory.buffer, p, b.length + 1)
+    m.set(b); m[b.length] = 0                 /// * \0 terminated
+    return p
+}
+function vm_wake(h, src) {                    ///> resume VM h
+    if (!vm_susp.delete(h)) return            /// * not suspended
+    vm_done(h, wasmExports.vm_wake(h, src))
+}
+///
+/// frame pipeline, see frames/frame-swap in ceforth.cpp
+///
+/// @note: Forth fills the back buffer while the front one, swapped in by
+///        frame-swap, is copied out once per animation frame as a single
+///        ['frm', [seq, Float32Array]]; frames swapped in between are skipped
+///
+let vm_fseq = 0                                ///< last frame shipped
+let vm_fraf = 0                                ///< shipping scheduled
+const vm_raf = self.requestAnimationFrame      ///< worker rAF, where supported
+    ? f=>self.requestAnimationFrame(f)
+    : f=>setTimeout(f, 16)
+function vm_frame() {                          ///> after each run of main VM
+    if (vm_fraf || vm_h().frm_seq == vm_fseq) return
+    vm_fraf = 1
+    vm_raf(()=>{
+        vm_fraf = 0
+        const h = vm_h()
+        if (!h.frm_adr || h.frm_seq == vm_fseq) return
+        vm_fseq = h.frm_seq
+        const f = new Float32Array(vm_buf(), h.frm_adr, h.frm_n * FRM_SLOT).slice()
+        vm_post([ 'frm', [ vm_fseq, f ] ], [ f.buffer ])
+    })
+}
+function vm_done(h, r) {                      ///> VM h back from a run
+    if (!h) vm_frame()
+    if (r==2) return                          /// * suspended again
+    if (h) {                                  /// * no front-end, resume held VM here
+        if (r==1) { vm_susp.add(h); vm_later(()=>vm_wake(h, 0)) }
+        return
+    }
+    vm_post(['cmd', r])                       /// * 1: front-end resends to resume
+    if (!r && vm_pend.length) vm_cmd(vm_pend.shift())
+}
+function vm_cmd(v) {                          ///> command to main VM
+    if (vm_susp.has(0)) { vm_pend.push(v); return }  /// * run when woken and done
+    vm_done(0, forth(0, 0, v))
+}
+function vm_handle(k, v) {                            ///> one request
+    const post = (v)=>vm_post([k, v])                 ///> macro to response to front-end
     switch (k) {
-    case 'cmd': post(forth(0, v));           break    /// * call Forth VM (output=>Module.print)she
-    case 'key': forth(1, v); post(0);        break    /// * PUSH(v), clear keypress mode
+    case 'cmd': vm_cmd(v);                   break    /// * call Forth VM (output=>Module.print)
+    case 'key':                                       /// * PUSH(v), clear keypress mode
+        forth(0, 1, v); post(0); vm_wake(0, 0);       /// * and resume from KEY
+        break
     case 'dc' : post(get_dict());            break    /// * built-in words
     case 'usr': post(get_dict(true));        break    /// * colon words
     case 'ss' : post(get_ss());              break    /// * dump stack
-    case 'dm' :                                       /// * dump memory
-        const idx = v[0], n = v[1]
-        const here= wasmExports.vm_mem_idx()
-        const len = (n + 0x10) & ~0xf                 ///> 16-byte blocks
-        const off = idx < 0                           ///> idx < 0 => from 'HERE'
-            ? (here > len ? here - len : 0)
-            : idx
-        const ma  = get_mem(off & ~0xf, len)          ///> get memory ref
-        post(dump(ma, off));                 break
+    case 'dm' :                                       /// * dump memory, v[0] < 0 => from HERE
+        post(get_dump(v[0], v[1]));          break
     case 'mm' :
         const mm = get_mem(v[0], v[1])                ///> fetch memory block
-        postMessage(                                  /// * to front-end, transfer
-            [ k, mm ],
-            [ mm.buffer ]);                  break
+        vm_post(                                      /// * to front-end, transfer
+            [ k, mm ],                                /// * unless shared
+            mm.buffer instanceof SharedArrayBuffer
+            ? [] : [ mm.buffer ]);           break
     case 'px' :
         const px = get_px(v)                          ///> fetch px values from Forth
-        postMessage(                                  ///> to front-end, transfer
-            [ k, px ],
-            [ px[2].buffer, px[3].buffer ]); break
+        vm_post(                                      ///> to front-end, transfer
+            [ k, px ],                                /// * unless shared
+            px[2].buffer instanceof SharedArrayBuffer
+            ? [] : [ px[2].buffer, px[3].buffer ]); break
     default   : post('unknown type');
     }
 }
+self.onmessage = function(e) {                        ///> worker input message queue
+    let k = e.data[0], v = e.data[1]
+    if (k != 'bat') { vm_handle(k, v); return }
+    vm_batch = []; vm_xfer = []                       /// * hold replies
+    v.forEach(r=>vm_handle(r[0], r[1]))
+    const msg = vm_batch, xfer = vm_xfer
+    vm_batch = null; vm_xfer = []
+    postMessage([ 'bat', msg ], xfer)                 /// * one round trip
+}
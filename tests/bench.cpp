@@ -0,0 +1,85 @@
+///
+/// @file
+/// @brief eForth native benchmark harness (make bench)
+///
+/// Script layout (see tests/bench/*.fs)
+///    \ any comment               - description
+///    \ ops: N                    - ops per run (default: tokens in bench body)
+///    ...                         - setup lines, run once
+///    \ bench
+///    ...                         - bench body, timed per run
+///
+/// Each body runs WARMUP times untimed, then REPEAT times timed, through
+/// forth_vm(). Output goes to a sink so only the VM cost is measured.
+///
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "../src/ceforth.h"
+
+#define WARMUP  2
+#define REPEAT  5
+
+static long sink_n = 0;                             ///< output bytes swallowed
+static void sink(int n, const char *s) { sink_n += n; }
+
+static void run(const vector<string> &lines) {      ///< feed lines to VM
+    for (auto &l : lines) {
+        while (forth_vm(l.c_str(), sink));          /// * resume while VM==HOLD
+    }
+}
+static double bench(const char *fn) {
+    ifstream ifs(fn);
+    if (!ifs.is_open()) { cout << fn << " open failed!" << endl; return 0; }
+
+    vector<string> setup, body;
+    long   ops   = 0;
+    bool   timed = false;
+    string line;
+    while (getline(ifs, line)) {
+        if (line.rfind("\\ ops:", 0)==0) { ops = atol(line.c_str() + 6); continue; }
+        if (line.rfind("\\ bench", 0)==0) { timed = true; continue; }
+        (timed ? body : setup).push_back(line);
+    }
+    if (!ops) {                                     /// * default to token count
+        for (auto &l : body) {
+            istringstream in(l); string t;
+            while (in >> t) ops++;
+        }
+    }
+    run(setup);
+    for (int i = 0; i < WARMUP; i++) run(body);
+
+    double best = 1e30, sum = 0;
+    for (int i = 0; i < REPEAT; i++) {
+        auto t0 = chrono::steady_clock::now();
+        run(body);
+        auto t1 = chrono::steady_clock::now();
+        double ns = chrono::duration<double, nano>(t1 - t0).count() / ops;
+        best = ns < best ? ns : best;
+        sum += ns;
+    }
+    run({ "abort boot" });                          /// * clean slate for next script
+
+    const char *nm = strrchr(fn, '/');
+    cout << setw(12) << left  << (nm ? nm + 1 : fn)
+         << setw(12) << right << ops
+         << setw(12) << fixed << setprecision(2) << best
+         << setw(12) << sum / REPEAT << endl;
+    return best;
+}
+int main(int ac, char *av[]) {
+    forth_init();
+    cout << APP_VERSION << " native benchmark, "
+         << WARMUP << " warm-up + " << REPEAT << " runs" << endl;
+    cout << setw(12) << left  << "script"
+         << setw(12) << right << "ops"
+         << setw(12) << "best ns/op"
+         << setw(12) << "avg ns/op" << endl;
+    for (int i = 1; i < ac; i++) bench(av[i]);
+    return 0;
+}
@@ -0,0 +1,8 @@
+\ calls to short colon words, inlined or tail called (USE_INLINE)
+\ ops: 10000000
+: sq dup * ;
+: 2+ 2 + ;
+: xx 9999 for 3 sq 2+ drop next ;
+: yy 999 for xx next ;
+\ bench
+yy
@@ -0,0 +1,43 @@
+\ find()-bound compile, ops = tokens parsed by the outer interpreter (auto-counted)
+\ bench
+: c0 dup drop over swap rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ 1- 0= ;
+: c1 2dup 2drop + - * and or xor abs negate 1+ 1- 0= < > = max min dup drop ;
+: c2 xor abs negate 1+ 1- 0= < > = max min dup drop over swap rot -rot nip 2dup 2drop ;
+: c3 > = max min dup drop over swap rot -rot nip 2dup 2drop + - * and or xor abs ;
+: c4 swap rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ 1- 0= < > = ;
+: c5 - * and or xor abs negate 1+ 1- 0= < > = max min dup drop over swap rot ;
+: c6 1+ 1- 0= < > = max min dup drop over swap rot -rot nip 2dup 2drop + - * ;
+: c7 min dup drop over swap rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ 1- ;
+: c8 nip 2dup 2drop + - * and or xor abs negate 1+ 1- 0= < > = max min dup ;
+: c9 or xor abs negate 1+ 1- 0= < > = max min dup drop over swap rot -rot nip 2dup ;
+: c10 < > = max min dup drop over swap rot -rot nip 2dup 2drop + - * and or xor ;
+: c11 over swap rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ 1- 0= < > ;
+: c12 + - * and or xor abs negate 1+ 1- 0= < > = max min dup drop over swap ;
+: c13 negate 1+ 1- 0= < > = max min dup drop over swap rot -rot nip 2dup 2drop + - ;
+: c14 max min dup drop over swap rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ ;
+: c15 -rot nip 2dup 2drop + - * and or xor abs negate 1+ 1- 0= < > = max min ;
+: c16 and or xor abs negate 1+ 1- 0= < > = max min dup drop over swap rot -rot nip ;
+: c17 0= < > = max min dup drop over swap rot -rot nip 2dup 2drop + - * and or ;
+: c18 drop over swap rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ 1- 0= < ;
+: c19 2drop + - * and or xor abs negate 1+ 1- 0= < > = max min dup drop over ;
+: c20 abs negate 1+ 1- 0= < > = max min dup drop over swap rot -rot nip 2dup 2drop + ;
+: c21 = max min dup drop over swap rot -rot nip 2dup 2drop + - * and or xor abs negate ;
+: c22 rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ 1- 0= < > = max ;
+: c23 * and or xor abs negate 1+ 1- 0= < > = max min dup drop over swap rot -rot ;
+: c24 1- 0= < > = max min dup drop over swap rot -rot nip 2dup 2drop + - * and ;
+: c25 dup drop over swap rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ 1- 0= ;
+: c26 2dup 2drop + - * and or xor abs negate 1+ 1- 0= < > = max min dup drop ;
+: c27 xor abs negate 1+ 1- 0= < > = max min dup drop over swap rot -rot nip 2dup 2drop ;
+: c28 > = max min dup drop over swap rot -rot nip 2dup 2drop + - * and or xor abs ;
+: c29 swap rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ 1- 0= < > = ;
+: c30 - * and or xor abs negate 1+ 1- 0= < > = max min dup drop over swap rot ;
+: c31 1+ 1- 0= < > = max min dup drop over swap rot -rot nip 2dup 2drop + - * ;
+: c32 min dup drop over swap rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ 1- ;
+: c33 nip 2dup 2drop + - * and or xor abs negate 1+ 1- 0= < > = max min dup ;
+: c34 or xor abs negate 1+ 1- 0= < > = max min dup drop over swap rot -rot nip 2dup ;
+: c35 < > = max min dup drop over swap rot -rot nip 2dup 2drop + - * and or xor ;
+: c36 over swap rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ 1- 0= < > ;
+: c37 + - * and or xor abs negate 1+ 1- 0= < > = max min dup drop over swap ;
+: c38 negate 1+ 1- 0= < > = max min dup drop over swap rot -rot nip 2dup 2drop + - ;
+: c39 max min dup drop over swap rot -rot nip 2dup 2drop + - * and or xor abs negate 1+ ;
+forget c0
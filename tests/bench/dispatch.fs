@@ -0,0 +1,6 @@
+\ dispatch-bound loops, README 10M benchmark (nest() + FOR..NEXT)
+\ ops: 10000000
+: xx 9999 for 34 drop next ;
+: yy 999 for xx next ;
+\ bench
+yy
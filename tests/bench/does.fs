@@ -0,0 +1,7 @@
+\ create/does> objects, each call goes through VBRAN and the does> body
+\ ops: 1000000
+: const create , does> @ ;
+5 const five
+: dd 999999 for five drop next ;
+\ bench
+dd
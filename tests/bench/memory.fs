@@ -0,0 +1,7 @@
+\ memory @ ! +! traffic on a variable and an array
+\ ops: 1000000
+variable v
+create arr 100 cells allot
+: mm 9999 for 99 for i arr i th ! arr i th @ v +! next next ;
+\ bench
+mm
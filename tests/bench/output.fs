@@ -0,0 +1,5 @@
+\ string/number output through fout (sink callback in the harness)
+\ ops: 100000
+: oo 9999 for 9 for i . next ." x" cr next ;
+\ bench
+oo
@@ -0,0 +1,7 @@
+\ vector words vdot v+ over 1000-cell arrays, ops counted per element
+\ ops: 2000000
+create xa 1000 cells allot
+create xb 1000 cells allot
+: vv 999 for xa xb 1000 vdot drop xa xb xa 1000 v+ next ;
+\ bench
+vv
@@ -0,0 +1,15 @@
+\ number parser - literals, and words that start with a digit
+\ words first: 1+ 2* 0= 2dup 2drop are found, not parsed
+5 1+ . 6 2* . 0 0= . 7 0= . 3 4 2dup . . . . 8 9 2drop .s
+: t2 1+ 2* ; 4 t2 .
+\ prefixes: % binary, # decimal, $ and & hex, 0x hex
+%101 . %-11 . #99 . #-42 . $ff . $-10 . &12 . 0x1f .
+\ explicit signs, - alone is a word
++7 . -5 . +0 . -0 . 5 3 - .
+\ float forms
+3.14 . -0.5 . +2.5 . .5 . 1e3 . 2.5e-3 . 1E2 . -1.5e+2 . 100000000 .
+1.2e-38 . 3.4e38 . 0.1 . 1e-30 . 123456789 . 12345678901234 .
+\ hex mode: plain digits are radix 16, prefixes still apply
+hex ff . 7f . -10 . #10 . %11 . abc . 1+ 2 1+ . decimal 10 .
+\ a bad token prints token? and leaves what was parsed of it
+1e . 12abc . 1e-50 . $ . 0x . 7 .
@@ -0,0 +1,8 @@
+\ pmem full - overflow the growable pmem (USE_IU32), the VM keeps answering
+\ each overflow prints pmem full and skips the rest of its line
+create x 300000000 allot 1 2 + .
+3 4 + .
+: stuff begin 0 , again ; stuff 5 6 + .
+7 8 + .
+forget x
+: sq dup * ; 9 sq .
@@ -9,6 +9,6 @@
   0 0 0   ds .V!                          \ linear velocity[x, y, z]
   0 0 0   ds .W!                          \ angular velocity[x, y, z]
   color 3 px DSZ ds
-  s" body %x %p %p" JS ;
+  s" body %x %p %p" JSB ;
 box
 .( Cast.fs loaded )
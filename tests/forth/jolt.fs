@@ -23,5 +23,5 @@ DYNASET  ds                            \ dynamic setting [id,pos[3],rot[4],v[3],
   0 -5 0   ds .P!                        \ pos xyz=[0,-5,0]
   0 0 0 1  ds .R!                        \ rot xyzw=[0,0,0,1]
   $f0fff0 3 px DSZ ds                    \ color, gemoetry, shape config
-  s" sandbox %x %p %p" JS ;            \ foreward to front-end thread
+  s" sandbox %x %p %p" JSB ;            \ foreward to front-end thread
 .( Jolt.fs loaded )
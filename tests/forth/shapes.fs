@@ -23,11 +23,11 @@ create fg                              \ default colors for shapes
   1 id +! id @                         \ fetch id
   rnd_bdy rnd_geo rnd_v rnd_w          \ create random shape, geometry, velocities
   color 3 px DSZ ds                    \ get color, geometry, shape config
-  s" body %x %p %p" JS ;               \ foreward to front-end thread
+  s" body %x %p %p" JSB ;               \ foreward to front-end thread
 : ten  9 for one 250 delay next ;
 : spit 9 for ten i 10 * . cr next ;
 \ shape removal
-: remove ( id -- ) s" drop %d" JS ;    \ remove body with given id from scene
+: remove ( id -- ) s" drop %d" JSB ;    \ remove body with given id from scene
 : wipe
   id @ for i 1+ remove 100 delay next
   0 id ! ;
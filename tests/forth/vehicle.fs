@@ -7,14 +7,14 @@ sandbox
   ID ds !                              \ bike id
   0 0 0 ds .P! 0 0 0 1 ds .R!          \ pos[3], rot[4]
   $00ff00 3 px DSZ ds                  \ create bike body
-  s" bike %x %p %p" JS
+  s" bike %x %p %p" JSB
   150 10000 1000 px 3!                 \ set engine params
-  ID 3 px s" engine %x %p" JS
+  ID 3 px s" engine %x %p" JSB
   2 8000 2000 px 3!                    \ set transmission params
-  ID 3 px s" gearbox %x %p" JS ;
+  ID 3 px s" gearbox %x %p" JSB ;
 : wheel ( n -- ) ds !                  \ keep wheel index
   ID 3 px DSZ ds                       \ create front wheel
-  s" wheel %x %p %p" JS ;
+  s" wheel %x %p %p" JSB ;
 : front_wheel ( -- )
   0 -0.2 0.65    ds .P!                \ pos[x,y,z]
   1.5 0.3 0.5    ds .V!                \ suspension[freq, min, max]
@@ -29,11 +29,11 @@ sandbox
   ID ds !                              \ body id
   0 10 0 ds .P! 0 0 0 1 ds .R!         \ pos[3], rot[4]
   $00ff00 3 px DSZ ds                  \ create car body
-  s" fwd %x %p %p" JS
+  s" fwd %x %p %p" JSB
   800 10000 1000 px 3!                 \ set engine params
-  ID 3 px s" engine %x %p" JS
+  ID 3 px s" engine %x %p" JSB
   2 8000 2000 px 3!                    \ set transmission params
-  ID 3 px s" gearbox %x %p" JS ;
+  ID 3 px s" gearbox %x %p" JSB ;
 : car_wheels ( -- )
   0.8 0.1 1.2    ds .P!                \ relative pos[x,y,z]
   1.5 0.3 0.5    ds .V!                \ suspension[freq, min, max]
@@ -43,7 +43,7 @@ sandbox
   0.8 0.1 -1.2   ds .P!                \ pos[x,y,z]
   0 dup 500      ds .W!  2 wheel       \ RL wheel, steering, caster, break strength
   -0.8 0.1 -1.2  ds .P!  3 wheel ;     \ RR wheel, pos[x,y,z]
-: start s" start" JS ID 1+ to ID ;
+: start s" start" JSB ID 1+ to ID ;
 : go_bike
   bike front_wheel back_wheel start ;
 : go_car